@@ -0,0 +1,154 @@
+/************************************************************************
+
+    benchstream.h
+
+    Shared benchmark streams and timing
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+
+#ifndef BENCHSTREAM_H
+#define BENCHSTREAM_H
+
+// Helpers shared by the parser benchmarks: a generator for BeebSCSI-like
+// serial streams, recorded log loading and a loop that times a stream fed
+// through in serial-port sized chunks.
+//
+// The synthetic streams are made larger than the last-level cache, so
+// every pass reads its input from memory as a long serial log would,
+// rather than measuring a buffer that stays in the cache.
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include <unistd.h>
+
+// Lines typical of BeebSCSI with debug output enabled
+static const char *const debugLines[] = {
+    "SCSI Commands: Command = READ6 (0x08)\r\n",
+    "SCSI Commands: Target LUN = 0, LBA = 0x00012A, Blocks = 1\r\n",
+    "SCSI Commands: Transferring 256 bytes to host\r\n",
+    "SCSI Commands: STATUS phase - status = 0x00 (GOOD)\r\n",
+    "SCSI Commands: MESSAGE IN phase - message = 0x00\r\n",
+    "SCSI Commands: BUS FREE\r\n"
+};
+static const size_t debugLineCount = sizeof(debugLines) / sizeof(debugLines[0]);
+
+// Commands typical of the BBC Master's VFS
+static const char *const commandMix[] = {
+    "?F", "F12345R", "F1234N", "?P", "F54000S", "F100I", "N", "*",
+    "A1", "B0", "E1", "VP1", "!12", "?U", "$1", ")0", "X", "F77Q"
+};
+static const size_t commandCount = sizeof(commandMix) / sizeof(commandMix[0]);
+
+class BenchStream
+{
+public:
+    struct Timing {
+        double seconds;
+        double bytes;
+    };
+
+    // Size of a synthetic stream: twice the last-level cache, but at least
+    // 64 MB and at most 1 GB
+    static size_t streamSize(void)
+    {
+        const size_t minimumSize = 64u << 20;
+        const size_t maximumSize = 1024u << 20;
+        size_t size = minimumSize;
+
+#ifdef _SC_LEVEL3_CACHE_SIZE
+        long cacheSize = sysconf(_SC_LEVEL3_CACHE_SIZE);
+        if (cacheSize <= 0) cacheSize = sysconf(_SC_LEVEL2_CACHE_SIZE);
+        if (cacheSize > 0 && 2 * static_cast<size_t>(cacheSize) > size) size = 2 * static_cast<size_t>(cacheSize);
+#endif
+
+        return size < maximumSize ? size : maximumSize;
+    }
+
+    // Build a stream of about 'size' bytes: 'lines' lines of debug text, then
+    // 'fcodes' F-codes from the command mix, repeated, with a user code after
+    // every 64 F-codes
+    static std::string build(size_t size, size_t lines, size_t fcodes)
+    {
+        std::string stream;
+        stream.reserve(size + 256);
+        size_t line = 0;
+        size_t command = 0;
+
+        if (lines == 0 && fcodes == 0) lines = 1;
+
+        while (stream.size() < size) {
+            for (size_t i = 0; i < lines; i++) stream += debugLines[line++ % debugLineCount];
+            for (size_t i = 0; i < fcodes; i++) {
+                stream += "<FCODE>";
+                stream += commandMix[command % commandCount];
+                stream += "</FCODE>\r\n";
+                if (++command % 64 == 0) stream += "<UCD>MASTER</UCD>\r\n";
+            }
+        }
+
+        return stream;
+    }
+
+    // Read a recorded serial log (false if it cannot be read or is empty)
+    static bool load(const char *fileName, std::string &stream)
+    {
+        std::ifstream file(fileName, std::ios::binary);
+        if (!file) {
+            std::fprintf(stderr, "Cannot open %s\n", fileName);
+            return false;
+        }
+
+        stream.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return !stream.empty();
+    }
+
+    // Pass the stream to feed(data, length) in chunks of chunkSize bytes,
+    // repeating a short stream (such as a small log) until at least
+    // minimumBytes have been fed so that the timing is meaningful
+    template <typename Feed>
+    static Timing run(const std::string &stream, size_t chunkSize, size_t minimumBytes, Feed feed)
+    {
+        size_t passes = 1;
+        while (passes * stream.size() < minimumBytes) passes *= 2;
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t pass = 0; pass < passes; pass++) {
+            for (size_t offset = 0; offset < stream.size(); offset += chunkSize) {
+                size_t length = stream.size() - offset;
+                if (length > chunkSize) length = chunkSize;
+                feed(stream.data() + offset, length);
+            }
+        }
+
+        Timing timing;
+        timing.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        timing.bytes = static_cast<double>(stream.size()) * passes;
+        return timing;
+    }
+};
+
+#endif // BENCHSTREAM_H
@@ -0,0 +1,116 @@
+/************************************************************************
+
+    fcodedecoderbench.cpp
+
+    F-code decoder microbenchmark
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+// Measures the cost of decoding an F-code with the original QString based
+// parser (as used by PlayerEmulator::receiveFcode() before FcodeDecoder)
+// against FcodeDecoder::decode().  Usage: vp415_fcode_bench [iterations]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <QByteArray>
+#include <QString>
+
+#include "fcodedecoder.h"
+
+// A typical mix of commands sent by the BBC Master's VFS
+static const char *const commandMix[] = {
+    "?F", "F12345R", "F1234N", "?P", "F54000S", "F100I", "N", "*",
+    "A1", "B0", "E1", "VP1", "!12", "?U", "$1", ")0", "X", "F77Q"
+};
+static const size_t commandCount = sizeof(commandMix) / sizeof(commandMix[0]);
+
+// The original decode path: a QByteArray per command, a QString for the
+// debug output and a QString mid()/toInt() for picture numbers
+static int legacyDecode(const char *text)
+{
+    QByteArray fcodeBuffer(text);
+    QString debugString = QString(fcodeBuffer);
+    int x = debugString.length();
+
+    switch (fcodeBuffer[0]) {
+        case 'F':
+        if (fcodeBuffer.length() >= 3 && fcodeBuffer.length() <= 7) {
+            QString fcodeBufferString = QString(fcodeBuffer);
+            QString parameterString = fcodeBufferString.mid(1, fcodeBufferString.length() - 2);
+            x += parameterString.toInt();
+        }
+        break;
+
+        case '!':
+        if (fcodeBuffer.length() == 3) x += (fcodeBuffer[1] - '0') + (fcodeBuffer[2] - '0');
+        break;
+
+        default:
+        x += fcodeBuffer[fcodeBuffer.length() - 1];
+        break;
+    }
+
+    return x;
+}
+
+// The same commands through the allocation free decoder
+static int newDecode(const char *text, size_t length)
+{
+    FcodeCommand command;
+    FcodeDecoder::decode(text, length, command);
+    return static_cast<int>(command.opcode) + command.x + command.y + command.parameter;
+}
+
+int main(int argc, char *argv[])
+{
+    long iterations = (argc > 1) ? std::atol(argv[1]) : 200000;
+    if (iterations <= 0) iterations = 200000;
+
+    size_t lengths[commandCount];
+    for (size_t i = 0; i < commandCount; i++) lengths[i] = std::strlen(commandMix[i]);
+
+    // The checksums stop the compiler from discarding the work
+    volatile int checksum = 0;
+    const long commands = iterations * static_cast<long>(commandCount);
+
+    auto start = std::chrono::steady_clock::now();
+    for (long n = 0; n < iterations; n++) {
+        for (size_t i = 0; i < commandCount; i++) checksum = checksum + legacyDecode(commandMix[i]);
+    }
+    auto legacyNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (long n = 0; n < iterations; n++) {
+        for (size_t i = 0; i < commandCount; i++) checksum = checksum + newDecode(commandMix[i], lengths[i]);
+    }
+    auto decoderNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("Commands decoded:  %ld per path\n", commands);
+    std::printf("QString decode:    %.1f ns/command\n", static_cast<double>(legacyNs) / commands);
+    std::printf("FcodeDecoder:      %.1f ns/command\n", static_cast<double>(decoderNs) / commands);
+    std::printf("Checksum:          %d\n", checksum);
+
+    return 0;
+}
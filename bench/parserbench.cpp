@@ -0,0 +1,107 @@
+/************************************************************************
+
+    parserbench.cpp
+
+    Serial parser throughput benchmark
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+// Measures the complete receive path used by the emulator - tag scanner,
+// F-code queue and F-code decoder - in MB/s and commands/s.  Synthetic
+// streams are always measured; recorded serial logs can be given on the
+// command line.  Usage: vp415_parser_bench [log file...]
+
+#include <cstdio>
+#include <string>
+
+#include "benchstream.h"
+#include "tagdemux.h"
+#include "fcodequeue.h"
+#include "fcodedecoder.h"
+
+// Run the stream through the parser in serial-port sized chunks, handling
+// the queued F-codes as the emulator does
+static void measure(const char *name, const std::string &stream, size_t chunkSize)
+{
+    TagDemux demux;
+    FcodeQueue queue;
+    FcodeCommand command;
+    size_t commands = 0;
+    size_t invalid = 0;
+
+    auto drain = [&]() {
+        while (const FcodeQueue::Command *queued = queue.front()) {
+            if (!FcodeDecoder::decode(queued->text, queued->length, command)) invalid++;
+            commands++;
+            queue.pop();
+        }
+    };
+
+    demux.addTag("FCODE", [&queue, &drain](const char *payload, size_t length) {
+        if (length == 0) return;
+        if (queue.isFull()) drain();
+        queue.push(payload, length, 0);
+    });
+    demux.addTag("UCD", [](const char *, size_t) {});
+
+    BenchStream::Timing timing = BenchStream::run(stream, chunkSize, 64u << 20, [&](const char *data, size_t length) {
+        queue.beginRead();
+        demux.putData(data, length);
+        queue.endRead();
+        drain();
+    });
+
+    std::printf("%-32s %5zu byte chunks  %8.1f MB/s  %11.0f commands/s  (%zu invalid, %llu dropped)\n",
+                name, chunkSize, timing.bytes / timing.seconds / 1e6, commands / timing.seconds, invalid,
+                static_cast<unsigned long long>(queue.droppedCommands()));
+}
+
+int main(int argc, char *argv[])
+{
+    static const size_t chunkSizes[] = { 16, 64, 512, 4096 };
+
+    struct {
+        const char *name;
+        size_t debugLines;
+    } synthetic[] = {
+        { "F-codes only", 0 },
+        { "F-codes with light debug", 2 },
+        { "F-codes with verbose debug", 50 }
+    };
+
+    size_t size = BenchStream::streamSize();
+    std::printf("Synthetic streams of %zu MB\n", size >> 20);
+
+    for (const auto &stream : synthetic) {
+        std::string data = BenchStream::build(size, stream.debugLines, 1);
+        for (size_t chunkSize : chunkSizes) measure(stream.name, data, chunkSize);
+    }
+
+    // Recorded serial logs
+    for (int i = 1; i < argc; i++) {
+        std::string data;
+        if (!BenchStream::load(argv[i], data)) continue;
+        for (size_t chunkSize : chunkSizes) measure(argv[i], data, chunkSize);
+    }
+
+    return 0;
+}
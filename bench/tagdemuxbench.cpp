@@ -0,0 +1,80 @@
+/************************************************************************
+
+    tagdemuxbench.cpp
+
+    Tag scanner throughput benchmark
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+// Measures TagDemux throughput on BeebSCSI debug output with F-codes mixed
+// in at several densities.  Recorded logs can be given on the command line
+// and are measured as well.  Usage: vp415_tagdemux_bench [log file...]
+
+#include <cstdio>
+#include <string>
+
+#include "benchstream.h"
+#include "tagdemux.h"
+
+// Feed the stream through the scanner in serial-port sized chunks and
+// print the throughput
+static void measure(const char *name, const std::string &stream, size_t chunkSize)
+{
+    TagDemux demux;
+    size_t messages = 0;
+    demux.addTag("FCODE", [&messages](const char *, size_t) { messages++; });
+    demux.addTag("UCD", [&messages](const char *, size_t) { messages++; });
+
+    BenchStream::Timing timing = BenchStream::run(stream, chunkSize, 256u << 20, [&demux](const char *data, size_t length) {
+        demux.putData(data, length);
+    });
+
+    std::printf("%-28s %6zu byte chunks  %9.1f MB/s  %12.0f messages/s\n",
+                name, chunkSize, timing.bytes / timing.seconds / 1e6, messages / timing.seconds);
+}
+
+int main(int argc, char *argv[])
+{
+    static const size_t densities[] = { 1, 10, 100, 1000, 0 };
+    static const size_t chunkSizes[] = { 64, 4096 };
+
+    size_t size = BenchStream::streamSize();
+    std::printf("Synthetic streams of %zu MB\n", size >> 20);
+
+    for (size_t density : densities) {
+        std::string stream = BenchStream::build(size, density > 0 ? density : 1, density > 0 ? 1 : 0);
+        char name[64];
+        if (density > 0) std::snprintf(name, sizeof(name), "1 F-code per %zu lines", density);
+        else std::snprintf(name, sizeof(name), "Debug text only");
+
+        for (size_t chunkSize : chunkSizes) measure(name, stream, chunkSize);
+    }
+
+    // Recorded logs
+    for (int i = 1; i < argc; i++) {
+        std::string stream;
+        if (!BenchStream::load(argv[i], stream)) continue;
+        for (size_t chunkSize : chunkSizes) measure(argv[i], stream, chunkSize);
+    }
+
+    return 0;
+}
@@ -0,0 +1,183 @@
+/************************************************************************
+
+    parserfuzzer.cpp
+
+    Serial parser fuzzing harness
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+// libFuzzer harness for the receive path: arbitrary bytes are split into
+// reads, passed through the tag scanner and F-code queue, and every
+// queued F-code is decoded.  Any crash, sanitizer report or broken
+// invariant (abort) is a bug; libFuzzer's -timeout option catches inputs
+// that make the parser go quadratic.
+//
+// Built with clang this links against libFuzzer.  Otherwise a small
+// driver is compiled in that runs each file given on the command line,
+// or pseudo-random input if there are none.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "tagdemux.h"
+#include "fcodequeue.h"
+#include "fcodedecoder.h"
+#include "fcodetable.h"
+
+static void check(bool condition, const char *message)
+{
+    if (!condition) {
+        std::fprintf(stderr, "Parser invariant broken: %s\n", message);
+        std::abort();
+    }
+}
+
+// Decode a queued F-code and check the result is self-consistent
+static void decodeCommand(const char *text, size_t length)
+{
+    FcodeCommand command;
+    bool valid = FcodeDecoder::decode(text, length, command);
+    const FcodeSyntax *syntax = FcodeDecoder::lookup(text, length);
+
+    check(valid == (command.error == FcodeCommand::errorType::none), "validity and error disagree");
+    check(!valid || command.opcode != FcodeCommand::opcodeType::invalid, "valid command has no opcode");
+    check(!valid || (syntax && syntax->opcode == command.opcode), "decoder and table lookup disagree");
+    check(!valid || command.negativeAck == nullptr, "valid command has a negative acknowledge");
+    check(command.sequenceLength <= FcodeCommand::maximumSequenceLength, "chapter sequence too long");
+    check(FcodeDecoder::opcodeName(command.opcode) != nullptr, "opcode has no name");
+    check(FcodeDecoder::errorName(command.error) != nullptr, "error has no name");
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    if (size == 0) return 0;
+
+    // The first byte picks the read size so that tags get split at every
+    // possible point
+    size_t chunkSize = 1 + data[0] % 64;
+    const char *stream = reinterpret_cast<const char *>(data + 1);
+    size_t length = size - 1;
+
+    TagDemux demux;
+    FcodeQueue queue;
+    uint64_t userCodes = 0;
+
+    // Handle the queued commands as the emulator does
+    auto drain = [&queue]() {
+        while (const FcodeQueue::Command *command = queue.front()) {
+            check(command->length > 0 && command->length <= TagDemux::maximumPayloadLength,
+                  "queued F-code length out of range");
+            decodeCommand(command->text, command->length);
+            queue.pop();
+        }
+    };
+
+    demux.addTag("FCODE", [&queue, &drain](const char *payload, size_t payloadLength) {
+        check(payloadLength <= TagDemux::maximumPayloadLength, "payload longer than the buffer");
+        if (payloadLength == 0) return;
+        if (queue.isFull()) drain();
+        queue.push(payload, payloadLength, 0);
+    });
+    demux.addTag("UCD", [&userCodes](const char *, size_t payloadLength) {
+        check(payloadLength <= TagDemux::maximumPayloadLength, "payload longer than the buffer");
+        userCodes++;
+    });
+
+    for (size_t offset = 0; offset < length; offset += chunkSize) {
+        size_t readLength = length - offset;
+        if (readLength > chunkSize) readLength = chunkSize;
+
+        queue.beginRead();
+        demux.putData(stream + offset, readLength);
+        queue.endRead();
+
+        check(queue.size() <= FcodeQueue::capacity, "queue larger than its capacity");
+        drain();
+    }
+
+    check(queue.droppedCommands() == 0, "complete F-code dropped");
+
+    check(demux.discardedBytes() <= length, "more bytes discarded than received");
+
+    // The decoder must also cope with raw bytes that never went through
+    // the scanner
+    decodeCommand(stream, length < TagDemux::maximumPayloadLength ? length : TagDemux::maximumPayloadLength);
+
+    return 0;
+}
+
+#ifndef VP415_LIBFUZZER
+// Stand-alone driver for compilers without libFuzzer
+int main(int argc, char *argv[])
+{
+    static uint8_t buffer[1 << 16];
+
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            FILE *file = std::fopen(argv[i], "rb");
+            if (!file) {
+                std::fprintf(stderr, "Cannot open %s\n", argv[i]);
+                continue;
+            }
+            size_t size = std::fread(buffer, 1, sizeof(buffer), file);
+            std::fclose(file);
+            LLVMFuzzerTestOneInput(buffer, size);
+        }
+        return 0;
+    }
+
+    // Random inputs built mostly from pieces of real traffic so that the
+    // interesting states are reached
+    static const char *const pieces[] = {
+        "<FCODE>", "</FCODE>", "<UCD>", "</UCD>", "<", ">", "/", "F12345R", "?F", "VP", "!1",
+        "Q0312S", "*10+5", "N1-", "T1234N", "S40F", "#@A", "+", "-",
+        "\r\n", " ", "SCSI debug ", "<FCODEX>", "0123456789"
+    };
+    const size_t pieceCount = sizeof(pieces) / sizeof(pieces[0]);
+
+    std::srand(1);
+    for (int run = 0; run < 100000; run++) {
+        size_t size = 0;
+        buffer[size++] = static_cast<uint8_t>(std::rand());
+        size_t target = 1 + static_cast<size_t>(std::rand()) % 2048;
+
+        while (size < target) {
+            if (std::rand() % 4 == 0) {
+                buffer[size++] = static_cast<uint8_t>(std::rand());
+            } else {
+                const char *piece = pieces[static_cast<size_t>(std::rand()) % pieceCount];
+                size_t pieceLength = std::strlen(piece);
+                if (size + pieceLength > target) break;
+                std::memcpy(buffer + size, piece, pieceLength);
+                size += pieceLength;
+            }
+        }
+
+        LLVMFuzzerTestOneInput(buffer, size);
+    }
+
+    std::printf("100000 random inputs parsed without error\n");
+    return 0;
+}
+#endif
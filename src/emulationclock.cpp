@@ -0,0 +1,300 @@
+/************************************************************************
+
+    emulationclock.cpp
+
+    Emulation clock functions
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#include "emulationclock.h"
+
+#include <chrono>
+
+EmulationClock::EmulationClock(QObject *parent) : QThread(parent)
+{
+    startNs = MonotonicClock::nowNs();
+    resetJitter();
+
+    virtualTime = false;
+    virtualField = 0;
+    participants = 0;
+    lastActivityNs = 0;
+    pollField = -1;
+    pendingPolls = 0;
+    nextEventField = -1;
+
+    wakeField = everyField;
+    rescheduled = false;
+}
+
+EmulationClock::~EmulationClock()
+{
+    stopClock();
+}
+
+void EmulationClock::startClock(void)
+{
+    if (isRunning()) return;
+
+    startNs = MonotonicClock::nowNs();
+    virtualField = 0;
+    wakeField = everyField;
+    resetJitter();
+    start(QThread::TimeCriticalPriority);
+}
+
+void EmulationClock::stopClock(void)
+{
+    if (!isRunning()) return;
+
+    // The mutexes make sure that a sleeping tick loop sees the request
+    {
+        std::lock_guard<std::mutex> locker(wakeMutex);
+        requestInterruption();
+        wakeCondition.notify_one();
+    }
+    {
+        std::lock_guard<std::mutex> locker(pollMutex);
+        pollCondition.notify_one();
+    }
+    wait();
+}
+
+void EmulationClock::setVirtualTime(bool enabled)
+{
+    if (!isRunning()) virtualTime = enabled;
+}
+
+bool EmulationClock::isVirtualTime(void) const
+{
+    return virtualTime;
+}
+
+void EmulationClock::addParticipant(void)
+{
+    participants++;
+}
+
+// Called by each poller once it has handled a tick (virtual time only)
+void EmulationClock::fieldPolled(qint64 field, qint64 eventField)
+{
+    if (!virtualTime) return;
+
+    std::lock_guard<std::mutex> locker(pollMutex);
+
+    // A poller that was too slow answers for a field the clock has left;
+    // counting it would cut short the wait for the current tick
+    if (field != pollField || pendingPolls == 0) return;
+
+    // Keep the earliest event reported for this tick
+    if (eventField >= 0 && (nextEventField < 0 || eventField < nextEventField)) nextEventField = eventField;
+
+    if (--pendingPolls == 0) pollCondition.notify_one();
+}
+
+// Stop ticking until the given field, or (if the field is negative) until
+// wake() is called (any thread)
+void EmulationClock::sleepUntil(qint64 field)
+{
+    std::lock_guard<std::mutex> locker(wakeMutex);
+    if (field >= 0) wakeField = field;
+    else wakeField = untilWoken;
+    rescheduled = true;
+    wakeCondition.notify_one();
+}
+
+// Tick every field again, starting from the next field boundary (any
+// thread)
+void EmulationClock::wake(void)
+{
+    std::lock_guard<std::mutex> locker(wakeMutex);
+    if (wakeField == everyField) return;
+
+    wakeField = everyField;
+    rescheduled = true;
+    wakeCondition.notify_one();
+}
+
+// Wakes a virtual clock that is waiting for the host
+void EmulationClock::noteActivity(void)
+{
+    if (!virtualTime) return;
+
+    std::lock_guard<std::mutex> locker(pollMutex);
+    lastActivityNs.store(MonotonicClock::nowNs(), std::memory_order_relaxed);
+    pollCondition.notify_one();
+}
+
+qint64 EmulationClock::currentField(void) const
+{
+    if (virtualTime) return virtualField.load();
+    return (MonotonicClock::nowNs() - startNs.load(std::memory_order_relaxed)) / fieldNs;
+}
+
+qint64 EmulationClock::lastJitterUs(void) const
+{
+    return lastJitterNs.load(std::memory_order_relaxed) / 1000;
+}
+
+qint64 EmulationClock::maximumJitterUs(void) const
+{
+    return maxJitterNs.load(std::memory_order_relaxed) / 1000;
+}
+
+qint64 EmulationClock::meanJitterUs(void) const
+{
+    qint64 samples = jitterSamples.load(std::memory_order_relaxed);
+    if (samples == 0) return 0;
+    return totalJitterNs.load(std::memory_order_relaxed) / samples / 1000;
+}
+
+void EmulationClock::resetJitter(void)
+{
+    lastJitterNs = 0;
+    maxJitterNs = 0;
+    totalJitterNs = 0;
+    jitterSamples = 0;
+}
+
+// Field tick loop (clock thread)
+void EmulationClock::run(void)
+{
+    if (virtualTime) runVirtualTime();
+    else runRealTime();
+}
+
+void EmulationClock::runRealTime(void)
+{
+    const qint64 origin = startNs.load(std::memory_order_relaxed);
+    qint64 nextField = 1;
+
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    while (!isInterruptionRequested()) {
+        // Aim for the next boundary on the fixed grid (if the thread was
+        // held up for more than a field the missed ticks are skipped), or
+        // for the wake-up field if the listener is idle
+        qint64 targetField = nextField;
+        if (wakeField > targetField) targetField = wakeField;
+        qint64 deadlineNs = origin + targetField * fieldNs;
+        rescheduled = false;
+
+        // MonotonicClock counts steady_clock nanoseconds, so the deadline
+        // can be handed straight to wait_until()
+        auto rescheduledOrStopped = [this] { return rescheduled || isInterruptionRequested(); };
+        bool interrupted;
+        if (wakeField == untilWoken) {
+            wakeCondition.wait(lock, rescheduledOrStopped);
+            interrupted = true;
+        } else {
+            interrupted = wakeCondition.wait_until(lock, std::chrono::steady_clock::time_point(std::chrono::nanoseconds(deadlineNs)),
+                                                   rescheduledOrStopped);
+        }
+
+        // Work out the deadline again if sleepUntil() or wake() was called,
+        // carrying on from the next field boundary after a long sleep
+        if (interrupted) {
+            qint64 nowField = (MonotonicClock::nowNs() - origin) / fieldNs;
+            if (nowField >= nextField) nextField = nowField + 1;
+            continue;
+        }
+
+        // Tick every field again once the wake-up field is reached
+        if (wakeField >= 0 && targetField >= wakeField) wakeField = everyField;
+        lock.unlock();
+
+        qint64 field = (MonotonicClock::nowNs() - origin) / fieldNs;
+        emit fieldTick(field);
+        nextField = field + 1;
+
+        lock.lock();
+    }
+}
+
+// Virtual time never waits for an event that nothing can happen before, so
+// searches, delayed responses and play up to a STOP register take only as
+// long as it takes to emulate them
+void EmulationClock::runVirtualTime(void)
+{
+    qint64 field = 0;
+    auto stopped = [this] { return isInterruptionRequested(); };
+
+    while (!isInterruptionRequested()) {
+        qint64 tickNs = MonotonicClock::nowNs();
+
+        // Hand the field to the pollers and wait for all of them to finish
+        std::unique_lock<std::mutex> lock(pollMutex);
+        pollField = field;
+        pendingPolls = participants.load();
+        nextEventField = -1;
+        virtualField = field;
+        lock.unlock();
+
+        emit fieldTick(field);
+
+        lock.lock();
+        pollCondition.wait_until(lock, std::chrono::steady_clock::time_point(std::chrono::nanoseconds(tickNs + pollTimeoutNs)),
+                                 [this] { return pendingPolls == 0 || isInterruptionRequested(); });
+        qint64 eventField = nextEventField;
+
+        // Wait for the host to go quiet, but never for longer than a real
+        // field; while it is still busy the field advances at the real rate
+        qint64 nowNs = MonotonicClock::nowNs();
+        while (!isInterruptionRequested()) {
+            qint64 untilNs = lastActivityNs.load(std::memory_order_relaxed) + idleWindowNs;
+            if (untilNs > tickNs + fieldNs) untilNs = tickNs + fieldNs;
+            if (nowNs >= untilNs) break;
+
+            pollCondition.wait_until(lock, std::chrono::steady_clock::time_point(std::chrono::nanoseconds(untilNs)), stopped);
+            nowNs = MonotonicClock::nowNs();
+        }
+
+        qint64 activityNs = lastActivityNs.load(std::memory_order_relaxed);
+        bool idle = nowNs - activityNs >= idleWindowNs;
+
+        // With the host quiet and nothing scheduled there is nothing to move
+        // on to, so wait for the host (noteActivity()) instead of ticking
+        if (idle && eventField < 0) {
+            pollCondition.wait(lock, [this, activityNs] {
+                return lastActivityNs.load(std::memory_order_relaxed) != activityNs || isInterruptionRequested();
+            });
+        }
+        lock.unlock();
+
+        if (idle && eventField > field) field = eventField;
+        else field++;
+    }
+}
+
+// Jitter is measured from the start of the field to the moment the
+// listener polls it, which includes any time the tick spent queued behind
+// other work in the listener's event loop
+void EmulationClock::recordPoll(qint64 field)
+{
+    // Virtual fields are not tied to real time
+    if (virtualTime) return;
+
+    qint64 jitterNs = MonotonicClock::nowNs() - (startNs.load(std::memory_order_relaxed) + field * fieldNs);
+    lastJitterNs.store(jitterNs, std::memory_order_relaxed);
+    if (jitterNs > maxJitterNs.load(std::memory_order_relaxed)) maxJitterNs.store(jitterNs, std::memory_order_relaxed);
+    totalJitterNs.fetch_add(jitterNs, std::memory_order_relaxed);
+    jitterSamples.fetch_add(1, std::memory_order_relaxed);
+}
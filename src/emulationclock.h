@@ -0,0 +1,144 @@
+/************************************************************************
+
+    emulationclock.h
+
+    Emulation clock header
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#ifndef EMULATIONCLOCK_H
+#define EMULATIONCLOCK_H
+
+#include <QThread>
+#include <QDebug>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+#include "monotonicclock.h"
+
+// Emulated time, counted in PAL video fields (20 ms).  The current field is
+// always worked out from the monotonic clock, so emulated time cannot drift
+// however late the emulation is polled.  A dedicated thread sleeps until
+// each field boundary and signals fieldTick(); the deadlines are fixed
+// multiples of the field period from the start time, so timer error does
+// not accumulate and a late wake-up simply skips to the current field.
+//
+// For automated test runs the clock can instead run on virtual time.  Each
+// field is then handed to the pollers, which report back with the field of
+// their next scheduled event; once every poller has finished and the host
+// has gone quiet, the clock jumps straight to that field.  While the host
+// is sending, fields are paced at the real PAL rate.
+//
+// A real-time clock can also be put to sleep when its listener has nothing
+// to do: it then ticks next at the requested field, or when woken by new
+// input, instead of every 20 ms.
+class EmulationClock : public QThread
+{
+    Q_OBJECT
+
+public:
+    static const qint64 fieldNs = 20000000;
+
+    explicit EmulationClock(QObject *parent = nullptr);
+    ~EmulationClock();
+
+    // Start and stop the field ticks (the field count starts from zero)
+    void startClock(void);
+    void stopClock(void);
+
+    // Run on virtual time (must be set before the clock is started)
+    void setVirtualTime(bool enabled);
+    bool isVirtualTime(void) const;
+
+    // Virtual time: pollers that answer each tick with fieldPolled(), the
+    // answer itself (the field polled, and nextEventField or -1 if nothing
+    // is scheduled) and host activity that keeps the clock at the real
+    // field rate, or wakes it once nothing is left to run (any thread).  An answer for a field the clock has already
+    // left, after timing out, is ignored.
+    void addParticipant(void);
+    void fieldPolled(qint64 field, qint64 nextEventField);
+    void noteActivity(void);
+
+    // Tickless idle: stop ticking until a field (or, for a negative field,
+    // until woken) and resume ticking every field (any thread)
+    void sleepUntil(qint64 field);
+    void wake(void);
+
+    // Fields since the clock was started (any thread)
+    qint64 currentField(void) const;
+
+    // Listeners report each field as they poll it, so that the jitter
+    // statistics show how late the polls really ran (any thread)
+    void recordPoll(qint64 field);
+
+    // How late the polls have been (any thread)
+    qint64 lastJitterUs(void) const;
+    qint64 maximumJitterUs(void) const;
+    qint64 meanJitterUs(void) const;
+    void resetJitter(void);
+
+signals:
+    // Emitted from the clock thread at each field boundary
+    void fieldTick(qint64 field);
+
+protected:
+    void run(void) override;
+
+private:
+    // How long the host must be quiet before the clock skips ahead, and
+    // how long a tick waits for a poller that is stuck
+    static const qint64 idleWindowNs = 2000000;
+    static const qint64 pollTimeoutNs = 100000000;
+
+    bool virtualTime;
+    std::atomic<qint64> virtualField;
+    std::atomic<int> participants;
+    std::atomic<qint64> lastActivityNs;
+
+    // The virtual tick being polled and the answers so far
+    std::mutex pollMutex;
+    std::condition_variable pollCondition;
+    qint64 pollField;
+    int pendingPolls;
+    qint64 nextEventField;
+
+    static const qint64 everyField = -1;
+    static const qint64 untilWoken = -2;
+
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    qint64 wakeField;
+    bool rescheduled;
+
+    void runRealTime(void);
+    void runVirtualTime(void);
+
+    std::atomic<qint64> startNs;
+    std::atomic<qint64> lastJitterNs;
+    std::atomic<qint64> maxJitterNs;
+    std::atomic<qint64> totalJitterNs;
+    std::atomic<qint64> jitterSamples;
+};
+
+#endif // EMULATIONCLOCK_H
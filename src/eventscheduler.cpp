@@ -0,0 +1,123 @@
+/************************************************************************
+
+    eventscheduler.cpp
+
+    Timed player event scheduler
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#include "eventscheduler.h"
+
+#include <algorithm>
+#include <cstring>
+
+EventScheduler::EventScheduler()
+{
+    // A player rarely has more than a few events pending, so the heap
+    // storage is reserved once and scheduling does not normally allocate
+    events.reserve(32);
+    sequenceCount = 0;
+}
+
+void EventScheduler::schedule(int64_t field, eventType type)
+{
+    Event event;
+    event.field = field;
+    event.type = type;
+    event.responseLength = 0;
+    event.arrivalNs = 0;
+    push(event);
+}
+
+void EventScheduler::scheduleResponse(int64_t field, const char *response, int64_t arrivalNs)
+{
+    Event event;
+    event.field = field;
+    event.type = eventType::response;
+    event.responseLength = std::min(strlen(response), maximumResponseLength);
+    memcpy(event.response, response, event.responseLength);
+    event.arrivalNs = arrivalNs;
+    push(event);
+}
+
+const EventScheduler::Event *EventScheduler::front(int64_t field) const
+{
+    if (events.empty() || events.front().field > field) return nullptr;
+    return &events.front();
+}
+
+void EventScheduler::pop(void)
+{
+    if (events.empty()) return;
+
+    std::pop_heap(events.begin(), events.end(), isLater);
+    events.pop_back();
+}
+
+int64_t EventScheduler::nextField(void) const
+{
+    return events.empty() ? -1 : events.front().field;
+}
+
+// Cancelling is O(n) in the pending events.  It runs after every F-code
+// (to move the register events), but only a handful of events are ever
+// pending, so the scan costs less than keeping a handle for each event.
+void EventScheduler::cancel(eventType type)
+{
+    auto end = std::remove_if(events.begin(), events.end(), [type](const Event &event) {
+        return event.type == type;
+    });
+    if (end == events.end()) return;
+
+    events.erase(end, events.end());
+    std::make_heap(events.begin(), events.end(), isLater);
+}
+
+void EventScheduler::clear(void)
+{
+    events.clear();
+}
+
+size_t EventScheduler::size(void) const
+{
+    return events.size();
+}
+
+bool EventScheduler::isEmpty(void) const
+{
+    return events.empty();
+}
+
+void EventScheduler::push(const Event &event)
+{
+    events.push_back(event);
+    events.back().sequence = sequenceCount++;
+    std::push_heap(events.begin(), events.end(), isLater);
+}
+
+// Heap ordering: the earliest field (then the earliest scheduled) is at the
+// front
+bool EventScheduler::isLater(const Event &first, const Event &second)
+{
+    if (first.field != second.field) return first.field > second.field;
+    return first.sequence > second.sequence;
+}
@@ -0,0 +1,92 @@
+/************************************************************************
+
+    eventscheduler.h
+
+    Timed player event scheduler header
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#ifndef EVENTSCHEDULER_H
+#define EVENTSCHEDULER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Holds the player's pending timed actions (delayed responses, resuming
+// play and unmuting after a search, and the STOP and INFO register
+// crossings) ordered by the emulated field they are due in.  The events
+// are kept in a binary heap, so scheduling and removing an event are
+// O(log n) however many are pending.  Events due in the same field are
+// run in the order they were scheduled.
+class EventScheduler
+{
+public:
+    static const size_t maximumResponseLength = 8;
+
+    enum class eventType {
+        response,
+        play,
+        unmute,
+        stopRegisterReached,
+        infoRegisterReached
+    };
+
+    struct Event {
+        int64_t field;
+        uint64_t sequence;
+        eventType type;
+        char response[maximumResponseLength];
+        size_t responseLength;
+        int64_t arrivalNs;
+    };
+
+    EventScheduler();
+
+    // Add an action or a response (truncated to maximumResponseLength) to
+    // be run in the given field
+    void schedule(int64_t field, eventType type);
+    void scheduleResponse(int64_t field, const char *response, int64_t arrivalNs);
+
+    // Earliest event that is due in or before the given field, or null
+    const Event *front(int64_t field) const;
+    void pop(void);
+
+    // Field of the earliest pending event, or -1 if there is none
+    int64_t nextField(void) const;
+
+    // Cancel the pending events of one type, or every pending event
+    void cancel(eventType type);
+    void clear(void);
+
+    size_t size(void) const;
+    bool isEmpty(void) const;
+
+private:
+    std::vector<Event> events;
+    uint64_t sequenceCount;
+
+    void push(const Event &event);
+    static bool isLater(const Event &first, const Event &second);
+};
+
+#endif // EVENTSCHEDULER_H
@@ -0,0 +1,262 @@
+/************************************************************************
+
+    faultinjector.cpp
+
+    Serial fault injection functions
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#include "faultinjector.h"
+
+FaultInjector::FaultInjector(Transport *inner, const SettingsDialog::FaultSettings &faults, QObject *parent) :
+    Transport(parent),
+    faults(faults),
+    random(faults.seed)
+{
+    // Take ownership of the real transport and intercept its signals
+    transport = inner;
+    transport->setParent(this);
+    connect(transport, &Transport::readyRead, this, &FaultInjector::innerReadyRead);
+    connect(transport, &Transport::bytesWritten, this, &FaultInjector::innerBytesWritten);
+    connect(transport, &Transport::fatalError, this, &Transport::fatalError);
+
+    timer = new QTimer(this);
+    timer->setTimerType(Qt::PreciseTimer);
+    timer->setSingleShot(true);
+    connect(timer, &QTimer::timeout, this, &FaultInjector::deliver);
+
+    clock.start();
+    lastIncomingNs = 0;
+    lastOutgoingNs = 0;
+
+    qDebug() << "FaultInjector: seed" << faults.seed << "latency" << faults.latencyMs << "ms jitter" << faults.jitterMs
+             << "ms drop" << faults.dropRate << "corrupt" << faults.corruptRate << "split" << faults.splitRate;
+}
+
+FaultInjector::~FaultInjector()
+{
+    close();
+}
+
+bool FaultInjector::open(void)
+{
+    return transport->open();
+}
+
+void FaultInjector::close(void)
+{
+    timer->stop();
+    incoming.clear();
+    outgoing.clear();
+    received.clear();
+    transport->close();
+}
+
+bool FaultInjector::isOpen(void) const
+{
+    return transport->isOpen();
+}
+
+QByteArray FaultInjector::readAll(void)
+{
+    QByteArray data = received;
+    received.clear();
+    return data;
+}
+
+qint64 FaultInjector::write(const QByteArray &data)
+{
+    qint64 dropped = 0;
+    enqueue(outgoing, lastOutgoingNs, damage(data, "tx", dropped), "tx");
+
+    // Dropped bytes will never be reported by the real transport, so report
+    // them here to keep the caller's in-flight accounting balanced
+    if (dropped > 0) emit bytesWritten(dropped);
+
+    return data.size();
+}
+
+QString FaultInjector::errorString(void) const
+{
+    return transport->errorString();
+}
+
+QString FaultInjector::endpointName(void) const
+{
+    return transport->endpointName();
+}
+
+// Parse a comma separated list of key=value pairs.  Rates are probabilities
+// per byte (drop, corrupt) or per byte boundary (split) from 0 to 1.
+bool FaultInjector::parseSpecification(const QString &specification, SettingsDialog::FaultSettings &faults, QString &error)
+{
+    const QStringList items = specification.split(',');
+
+    for (const QString &item : items) {
+        if (item.trimmed().isEmpty()) continue;
+
+        QString key = item.section('=', 0, 0).trimmed();
+        QString value = item.section('=', 1).trimmed();
+        bool ok = false;
+
+        if (key == "seed") faults.seed = value.toUInt(&ok);
+        else if (key == "latency") faults.latencyMs = value.toInt(&ok);
+        else if (key == "jitter") faults.jitterMs = value.toInt(&ok);
+        else if (key == "drop") faults.dropRate = value.toDouble(&ok);
+        else if (key == "corrupt") faults.corruptRate = value.toDouble(&ok);
+        else if (key == "split") faults.splitRate = value.toDouble(&ok);
+
+        if (!ok) {
+            error = QString("Invalid fault setting: ") + item;
+            return false;
+        }
+    }
+
+    if (faults.latencyMs < 0 || faults.jitterMs < 0 ||
+            faults.dropRate < 0.0 || faults.dropRate > 1.0 ||
+            faults.corruptRate < 0.0 || faults.corruptRate > 1.0 ||
+            faults.splitRate < 0.0 || faults.splitRate > 1.0) {
+        error = QString("Fault settings out of range: ") + specification;
+        return false;
+    }
+
+    faults.enabled = true;
+    return true;
+}
+
+// Data has arrived from the real transport
+void FaultInjector::innerReadyRead(void)
+{
+    qint64 dropped = 0;
+    enqueue(incoming, lastIncomingNs, damage(transport->readAll(), "rx", dropped), "rx");
+}
+
+void FaultInjector::innerBytesWritten(qint64 bytes)
+{
+    emit bytesWritten(bytes);
+}
+
+// Return a random number in the range [0, 1)
+double FaultInjector::chance(void)
+{
+    return std::generate_canonical<double, 32>(random);
+}
+
+// Drop and corrupt bytes according to the configured rates
+QByteArray FaultInjector::damage(const QByteArray &data, const char *direction, qint64 &dropped)
+{
+    QByteArray result;
+    result.reserve(data.size());
+
+    for (int i = 0; i < data.size(); i++) {
+        char byte = data.at(i);
+
+        if (faults.dropRate > 0.0 && chance() < faults.dropRate) {
+            qDebug() << "FaultInjector:" << direction << "dropped byte" << i << "of" << data.size() << "value" << static_cast<quint8>(byte);
+            dropped++;
+            continue;
+        }
+
+        if (faults.corruptRate > 0.0 && chance() < faults.corruptRate) {
+            char corrupted = byte ^ static_cast<char>(1 << (random() % 8));
+            qDebug() << "FaultInjector:" << direction << "corrupted byte" << i << "of" << data.size() << "value"
+                     << static_cast<quint8>(byte) << "->" << static_cast<quint8>(corrupted);
+            byte = corrupted;
+        }
+
+        result.append(byte);
+    }
+
+    return result;
+}
+
+// Split data into bursts and schedule each one after the configured delay.
+// Bursts never overtake each other, so the byte order is preserved.
+void FaultInjector::enqueue(QQueue<Delivery> &queue, qint64 &lastDueNs, const QByteArray &data, const char *direction)
+{
+    int start = 0;
+
+    while (start < data.size()) {
+        // Find the end of this burst
+        int end = start + 1;
+        while (end < data.size() && !(faults.splitRate > 0.0 && chance() < faults.splitRate)) end++;
+        if (end < data.size()) {
+            qDebug() << "FaultInjector:" << direction << "split burst after byte" << end - 1 << "of" << data.size();
+        }
+
+        qint64 delayNs = static_cast<qint64>(faults.latencyMs) * 1000000;
+        if (faults.jitterMs > 0) {
+            qint64 jitterNs = static_cast<qint64>(chance() * faults.jitterMs * 1000000.0);
+            qDebug() << "FaultInjector:" << direction << "delayed" << end - start << "bytes by"
+                     << (delayNs + jitterNs) / 1000 << "us";
+            delayNs += jitterNs;
+        } else if (delayNs > 0) {
+            qDebug() << "FaultInjector:" << direction << "delayed" << end - start << "bytes by" << delayNs / 1000 << "us";
+        }
+
+        Delivery delivery;
+        delivery.dueNs = qMax(clock.nsecsElapsed() + delayNs, lastDueNs);
+        delivery.data = data.mid(start, end - start);
+        lastDueNs = delivery.dueNs;
+        queue.enqueue(delivery);
+
+        start = end;
+    }
+
+    schedule();
+}
+
+// Arm the timer for the earliest pending delivery
+void FaultInjector::schedule(void)
+{
+    qint64 dueNs = -1;
+    if (!incoming.isEmpty()) dueNs = incoming.head().dueNs;
+    if (!outgoing.isEmpty() && (dueNs < 0 || outgoing.head().dueNs < dueNs)) dueNs = outgoing.head().dueNs;
+    if (dueNs < 0) return;
+
+    qint64 waitNs = dueNs - clock.nsecsElapsed();
+    timer->start(waitNs > 0 ? static_cast<int>((waitNs + 999999) / 1000000) : 0);
+}
+
+// Pass on everything that is now due (one burst per readyRead so that
+// split bursts really do arrive separately)
+void FaultInjector::deliver(void)
+{
+    qint64 nowNs = clock.nsecsElapsed();
+
+    while (!outgoing.isEmpty() && outgoing.head().dueNs <= nowNs) {
+        QByteArray data = outgoing.dequeue().data;
+
+        // write() has already accepted this data, so report anything the
+        // real transport refuses as written to keep the accounting balanced
+        qint64 accepted = transport->write(data);
+        if (accepted < 0) accepted = 0;
+        if (accepted < data.size()) emit bytesWritten(data.size() - accepted);
+    }
+
+    if (!incoming.isEmpty() && incoming.head().dueNs <= nowNs) {
+        received.append(incoming.dequeue().data);
+        emit readyRead();
+    }
+
+    schedule();
+}
@@ -0,0 +1,98 @@
+/************************************************************************
+
+    faultinjector.h
+
+    Serial fault injection function header
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#ifndef FAULTINJECTOR_H
+#define FAULTINJECTOR_H
+
+#include <QTimer>
+#include <QQueue>
+#include <QElapsedTimer>
+#include <QDebug>
+
+#include <random>
+
+#include "transport.h"
+
+// Sits between a transport and the rest of the emulator to simulate a slow
+// or lossy link.  Data in both directions can be delayed (fixed latency
+// plus random jitter), have bytes dropped or corrupted, and be split into
+// smaller bursts.  All randomness comes from a seeded generator so that a
+// failing run can be repeated, and every injected fault is logged.
+//
+// Transport::create() only inserts the injector when faults are enabled,
+// so a normal connection does not pass through it at all.
+class FaultInjector : public Transport
+{
+    Q_OBJECT
+
+public:
+    explicit FaultInjector(Transport *inner, const SettingsDialog::FaultSettings &faults, QObject *parent = nullptr);
+    ~FaultInjector();
+
+    bool open(void) override;
+    void close(void) override;
+    bool isOpen(void) const override;
+
+    QByteArray readAll(void) override;
+    qint64 write(const QByteArray &data) override;
+
+    QString errorString(void) const override;
+    QString endpointName(void) const override;
+
+    // Parse a fault specification such as "seed=1,latency=20,jitter=5,drop=0.01"
+    static bool parseSpecification(const QString &specification, SettingsDialog::FaultSettings &faults, QString &error);
+
+private slots:
+    void innerReadyRead(void);
+    void innerBytesWritten(qint64 bytes);
+    void deliver(void);
+
+private:
+    struct Delivery {
+        qint64 dueNs;
+        QByteArray data;
+    };
+
+    Transport *transport;
+    SettingsDialog::FaultSettings faults;
+    std::mt19937 random;
+
+    QElapsedTimer clock;
+    QTimer *timer;
+    QQueue<Delivery> incoming;
+    QQueue<Delivery> outgoing;
+    qint64 lastIncomingNs;
+    qint64 lastOutgoingNs;
+    QByteArray received;
+
+    double chance(void);
+    QByteArray damage(const QByteArray &data, const char *direction, qint64 &dropped);
+    void enqueue(QQueue<Delivery> &queue, qint64 &lastDueNs, const QByteArray &data, const char *direction);
+    void schedule(void);
+};
+
+#endif // FAULTINJECTOR_H
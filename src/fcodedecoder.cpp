@@ -0,0 +1,276 @@
+/************************************************************************
+
+    fcodedecoder.cpp
+
+    F-code decoder
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#include "fcodedecoder.h"
+#include "fcodetable.h"
+
+#include <cstring>
+
+// Number of decimal digits needed for a limit
+static size_t digitCount(int32_t value)
+{
+    size_t digits = 1;
+    while (value >= 10) {
+        value /= 10;
+        digits++;
+    }
+    return digits;
+}
+
+// Parse 'length' decimal digits; false if there are none or any character
+// is not a digit
+static bool parseDigits(const char *data, size_t length, int32_t &value)
+{
+    if (length == 0 || length > 9) return false;
+
+    value = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (data[i] < '0' || data[i] > '9') return false;
+        value = value * 10 + (data[i] - '0');
+    }
+    return true;
+}
+
+static bool inRange(int32_t value, int32_t minimum, int32_t maximum)
+{
+    return value >= minimum && value <= maximum;
+}
+
+// True if the F-code has the form described by the table row
+static bool matches(const FcodeSyntax &syntax, const char *data, size_t length)
+{
+    switch (syntax.shape) {
+        case FcodeSyntax::shapeType::none:
+        return length == 1;
+
+        case FcodeSyntax::shapeType::selector:
+        case FcodeSyntax::shapeType::overlay:
+        return length > 1 && data[1] == syntax.suffix;
+
+        case FcodeSyntax::shapeType::number:
+        case FcodeSyntax::shapeType::timeCode:
+        case FcodeSyntax::shapeType::chapterSequence:
+        if (length < 2) return false;
+        if (syntax.suffix) return data[length - 1] == syntax.suffix;
+        return data[length - 1] >= '0' && data[length - 1] <= '9';
+
+        case FcodeSyntax::shapeType::numberJump:
+        return length > 1 && memchr(data + 1, syntax.suffix, length - 1) != nullptr;
+
+        case FcodeSyntax::shapeType::digitPair:
+        case FcodeSyntax::shapeType::bytePair:
+        return true;
+    }
+
+    return false;
+}
+
+// Check the parameters of an F-code against its table row
+static FcodeCommand::errorType parseParameters(const FcodeSyntax &syntax, const char *data, size_t length,
+                                               FcodeCommand &command)
+{
+    const FcodeCommand::errorType invalidParameter = FcodeCommand::errorType::invalidParameter;
+    const FcodeCommand::errorType invalidLength = FcodeCommand::errorType::invalidLength;
+
+    switch (syntax.shape) {
+        case FcodeSyntax::shapeType::none:
+        break;
+
+        case FcodeSyntax::shapeType::selector:
+        if (length != 2) return invalidLength;
+        break;
+
+        case FcodeSyntax::shapeType::digitPair:
+        if (length != 3) return invalidLength;
+        if (!parseDigits(data + 1, 1, command.x) || !parseDigits(data + 2, 1, command.y)) return invalidParameter;
+        if (!inRange(command.x, syntax.minimumX, syntax.maximumX)) return invalidParameter;
+        if (!inRange(command.y, syntax.minimumY, syntax.maximumY)) return invalidParameter;
+        break;
+
+        case FcodeSyntax::shapeType::bytePair:
+        if (length != 3) return invalidLength;
+        command.x = static_cast<unsigned char>(data[1]);
+        command.y = static_cast<unsigned char>(data[2]);
+        if (!inRange(command.x, syntax.minimumX, syntax.maximumX)) return invalidParameter;
+        if (!inRange(command.y, syntax.minimumY, syntax.maximumY)) return invalidParameter;
+        break;
+
+        case FcodeSyntax::shapeType::number:
+        {
+            size_t digits = length - (syntax.suffix ? 2 : 1);
+            if (digits == 0 || digits > digitCount(syntax.maximumX)) return invalidLength;
+            if (!parseDigits(data + 1, digits, command.x)) return invalidParameter;
+            if (!inRange(command.x, syntax.minimumX, syntax.maximumX)) return invalidParameter;
+            break;
+        }
+
+        case FcodeSyntax::shapeType::numberJump:
+        {
+            // The matching row guarantees the separator is present
+            size_t separator = static_cast<size_t>(static_cast<const char *>(memchr(data + 1, syntax.suffix, length - 1)) - data);
+            size_t xDigits = separator - 1;
+            size_t yDigits = length - separator - 1;
+
+            if (xDigits == 0 || xDigits > digitCount(syntax.maximumX)) return invalidLength;
+            if (yDigits == 0 || yDigits > digitCount(syntax.maximumY)) return invalidLength;
+            if (!parseDigits(data + 1, xDigits, command.x)) return invalidParameter;
+            if (!parseDigits(data + separator + 1, yDigits, command.y)) return invalidParameter;
+            if (!inRange(command.x, syntax.minimumX, syntax.maximumX)) return invalidParameter;
+            if (!inRange(command.y, syntax.minimumY, syntax.maximumY)) return invalidParameter;
+
+            // The jump may be no more than 20 pictures per picture played
+            if (command.y > 20 * command.x) return invalidParameter;
+            break;
+        }
+
+        case FcodeSyntax::shapeType::timeCode:
+        {
+            // Minutes are mandatory; if seconds are given the minutes must
+            // be two digits
+            size_t digits = length - 2;
+            if (digits == 1 || digits == 2) {
+                if (!parseDigits(data + 1, digits, command.x)) return invalidParameter;
+                command.y = 0;
+            } else if (digits == 4) {
+                if (!parseDigits(data + 1, 2, command.x) || !parseDigits(data + 3, 2, command.y)) return invalidParameter;
+            } else {
+                return invalidLength;
+            }
+            if (!inRange(command.x, syntax.minimumX, syntax.maximumX)) return invalidParameter;
+            if (!inRange(command.y, syntax.minimumY, syntax.maximumY)) return invalidParameter;
+            break;
+        }
+
+        case FcodeSyntax::shapeType::chapterSequence:
+        {
+            // One chapter may be given as one or two digits; a sequence
+            // needs two digits per chapter
+            size_t digits = length - 2;
+            size_t chapterDigits = (digits <= 2) ? digits : 2;
+            if (digits == 0 || digits % chapterDigits != 0 ||
+                    digits / chapterDigits > FcodeCommand::maximumSequenceLength) return invalidLength;
+
+            for (size_t offset = 1; offset < length - 1; offset += chapterDigits) {
+                int32_t chapter;
+                if (!parseDigits(data + offset, chapterDigits, chapter)) return invalidParameter;
+                if (!inRange(chapter, syntax.minimumX, syntax.maximumX)) return invalidParameter;
+                command.sequence[command.sequenceLength++] = static_cast<uint8_t>(chapter);
+            }
+            command.x = command.sequence[0];
+            break;
+        }
+
+        case FcodeSyntax::shapeType::overlay:
+        if (length != 3) return invalidLength;
+        command.parameter = data[2];
+
+        // VPX asks for the current mode
+        if (command.parameter == 'X') break;
+        if (!parseDigits(data + 2, 1, command.x)) return invalidParameter;
+        if (!inRange(command.x, syntax.minimumX, syntax.maximumX)) return invalidParameter;
+        break;
+    }
+
+    return FcodeCommand::errorType::none;
+}
+
+const FcodeSyntax *FcodeDecoder::lookup(const char *data, size_t length)
+{
+    if (length == 0) return nullptr;
+
+    size_t code = static_cast<unsigned char>(data[0]);
+    if (code >= sizeof(fcodeIndex.count)) return nullptr;
+
+    const FcodeSyntax *syntax = &fcodeTable[fcodeIndex.first[code]];
+    for (size_t row = 0; row < fcodeIndex.count[code]; row++, syntax++) {
+        if (matches(*syntax, data, length)) return syntax;
+    }
+
+    return nullptr;
+}
+
+bool FcodeDecoder::decode(const char *data, size_t length, FcodeCommand &command)
+{
+    command.opcode = FcodeCommand::opcodeType::invalid;
+    command.error = FcodeCommand::errorType::none;
+    command.parameter = 0;
+    command.x = 0;
+    command.y = 0;
+    command.sequenceLength = 0;
+    command.negativeAck = nullptr;
+
+    if (length == 0) {
+        command.error = FcodeCommand::errorType::empty;
+        return false;
+    }
+
+    size_t code = static_cast<unsigned char>(data[0]);
+    if (code >= sizeof(fcodeIndex.count) || fcodeIndex.count[code] == 0) {
+        command.error = FcodeCommand::errorType::unknownCode;
+        return false;
+    }
+
+    const FcodeSyntax *syntax = lookup(data, length);
+    if (!syntax) {
+        // A known code in a form the table does not allow; the rows for a
+        // code share their negative acknowledge
+        command.error = FcodeCommand::errorType::invalidParameter;
+        command.negativeAck = fcodeTable[fcodeIndex.first[code]].negativeAck;
+        return false;
+    }
+
+    command.opcode = syntax->opcode;
+    command.error = parseParameters(*syntax, data, length, command);
+    if (command.error != FcodeCommand::errorType::none) {
+        command.negativeAck = syntax->negativeAck;
+        return false;
+    }
+
+    return true;
+}
+
+const char *FcodeDecoder::opcodeName(FcodeCommand::opcodeType opcode)
+{
+    // Only used for logging, so a scan of the table is fine
+    for (size_t row = 0; row < fcodeTableSize; row++) {
+        if (fcodeTable[row].opcode == opcode) return fcodeTable[row].description;
+    }
+
+    return "Invalid";
+}
+const char *FcodeDecoder::errorName(FcodeCommand::errorType error)
+{
+    switch (error) {
+        case FcodeCommand::errorType::none: return "none";
+        case FcodeCommand::errorType::empty: return "empty";
+        case FcodeCommand::errorType::unknownCode: return "unknown F-code";
+        case FcodeCommand::errorType::invalidParameter: return "invalid parameter";
+        case FcodeCommand::errorType::invalidLength: return "invalid length";
+    }
+
+    return "unknown";
+}
@@ -0,0 +1,160 @@
+/************************************************************************
+
+    fcodedecoder.h
+
+    F-code decoder header
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#ifndef FCODEDECODER_H
+#define FCODEDECODER_H
+
+#include <cstddef>
+#include <cstdint>
+
+// A decoded F-code.  The structure is plain data so that commands can be
+// dispatched, logged and tested without touching the player emulation.
+struct FcodeCommand {
+    enum class opcodeType : uint8_t {
+        invalid,
+        soundInsert,
+        rc5Output,
+        replaySwitchDisable,
+        replaySwitchEnable,
+        eject,
+        transmissionDelayOff,
+        transmissionDelayOn,
+        halt,
+        haltAndJumpForward,
+        haltAndJumpReverse,
+        instantJumpForward,
+        instantJumpReverse,
+        standby,
+        on,
+        pause,
+        resetToDefault,
+        pictureNumberRequest,
+        chapterNumberRequest,
+        discProgramStatusRequest,
+        playerStatusRequest,
+        userCodeRequest,
+        revisionLevelRequest,
+        audio1Off,
+        audio1On,
+        audio2Off,
+        audio2On,
+        chapterNumberDisplayOff,
+        chapterNumberDisplayOn,
+        pictureNumberDisplayOff,
+        pictureNumberDisplayOn,
+        videoOff,
+        videoOn,
+        loadPictureNumberInfoRegister,
+        loadPictureNumberStopRegister,
+        gotoPictureNumberAndHalt,
+        gotoPictureNumberAndPlay,
+        gotoPictureNumberAndContinue,
+        rcToComputerOff,
+        rcToComputerOn,
+        localControlOff,
+        localControlOn,
+        remoteControlOff,
+        remoteControlOn,
+        stillForward,
+        stillReverse,
+        playForward,
+        playForwardAndJumpForward,
+        playForwardAndJumpReverse,
+        playReverse,
+        playReverseAndJumpForward,
+        playReverseAndJumpReverse,
+        gotoChapterAndHalt,
+        gotoChapterAndPlay,
+        playChapterSequence,
+        slowRead,
+        fastRead,
+        setFastSpeed,
+        setSlowSpeed,
+        gotoTimeCode,
+        loadTimeCodeInfoRegister,
+        slowMotionForward,
+        slowMotionReverse,
+        videoOverlay,
+        fastForward,
+        clear,
+        fastReverse,
+        audio1FromInternal,
+        audio1FromExternal,
+        videoFromInternal,
+        videoFromExternal,
+        audio2FromInternal,
+        audio2FromExternal,
+        txtFromDiscOff,
+        txtFromDiscOn
+    };
+
+    enum class errorType : uint8_t {
+        none,
+        empty,              // No F-code characters
+        unknownCode,        // First character is not an F-code
+        invalidParameter,   // Parameter missing, malformed or out of range
+        invalidLength       // Too few or too many characters
+    };
+
+    static const size_t maximumSequenceLength = 7;
+
+    opcodeType opcode;
+    errorType error;
+    char parameter;         // Single character parameter (video overlay)
+    int32_t x;              // Numeric parameters
+    int32_t y;
+    uint8_t sequence[maximumSequenceLength];  // Chapters to play (QxxyyzzS)
+    uint8_t sequenceLength;
+
+    // Response to send when the command is rejected, or nullptr if the
+    // command has no negative acknowledge
+    const char *negativeAck;
+};
+
+struct FcodeSyntax;
+
+// Turns the characters between <FCODE> and </FCODE> into an FcodeCommand.
+// Decoding works directly on the received bytes and never allocates; the
+// syntax and parameter limits of each command come from the grammar table
+// in fcodetable.h.
+class FcodeDecoder
+{
+public:
+    // Returns true if the command is valid (command.error is none)
+    static bool decode(const char *data, size_t length, FcodeCommand &command);
+
+    // The table row matching an F-code, or nullptr if there is none.  The
+    // leading character indexes the rows for that code, which are then
+    // tried in turn against the length and shape of the command
+    static const FcodeSyntax *lookup(const char *data, size_t length);
+
+    // Names for logging
+    static const char *opcodeName(FcodeCommand::opcodeType opcode);
+    static const char *errorName(FcodeCommand::errorType error);
+};
+
+#endif // FCODEDECODER_H
@@ -42,11 +42,11 @@ FcodeMonitorDialog::~FcodeMonitorDialog()
     delete ui;
 }
 
-void FcodeMonitorDialog::putData(const QByteArray &data, bool timeStamp)
+void FcodeMonitorDialog::putData(const QByteArray &data, bool timeStamp, qint64 arrivalNs)
 {
     if (timeStamp) {
-        // Print a timestamp
-        ui->plainTextEdit->appendPlainText(tr("[") + QTime::currentTime().toString("HH:mm:ss.zzz") + tr("] "));
+        // Print the time the F-code arrived at the serial port
+        ui->plainTextEdit->appendPlainText(tr("[") + MonotonicClock::toTime(arrivalNs).toString("HH:mm:ss.zzz") + tr("] "));
 
         // Insert the data to the console widget (adds CR)
         ui->plainTextEdit->insertPlainText(QString(data));
@@ -55,11 +55,16 @@ void FcodeMonitorDialog::putData(const QByteArray &data, bool timeStamp)
         ui->plainTextEdit->appendPlainText(QString(data));
     }
 
+    // Describe the command using the same table as the player emulator
+    const FcodeSyntax *syntax = FcodeDecoder::lookup(data.constData(), static_cast<size_t>(data.size()));
+    if (syntax) ui->plainTextEdit->insertPlainText(tr(" - ") + tr(syntax->description));
+    else ui->plainTextEdit->insertPlainText(tr(" - Unknown F-code"));
+
     // Move to the bottom of the text
     ui->plainTextEdit->verticalScrollBar()->setValue(ui->plainTextEdit->verticalScrollBar()->maximum());
 }
 
-void FcodeMonitorDialog::putResponse(const QByteArray &data, bool timeStamp)
+void FcodeMonitorDialog::putResponse(const QByteArray &data, bool timeStamp, qint64 arrivalNs)
 {
     if (timeStamp) {
         // Print a timestamp
@@ -67,6 +72,11 @@ void FcodeMonitorDialog::putResponse(const QByteArray &data, bool timeStamp)
 
         // Insert the data to the console widget (adds CR)
         ui->plainTextEdit->insertPlainText(QString(data));
+
+        // Show how long the F-code has been waiting for this response
+        if (arrivalNs > 0) {
+            ui->plainTextEdit->insertPlainText(tr(" (%1 us after F-code)").arg((MonotonicClock::nowNs() - arrivalNs) / 1000));
+        }
     } else {
         // Append the data to the console widget
         ui->plainTextEdit->appendPlainText(tr("Response: "));
@@ -32,6 +32,9 @@
 #include <QScrollBar>
 #include <QTime>
 
+#include "monotonicclock.h"
+#include "fcodetable.h"
+
 #include "ui_fcodemonitordialog.h"
 
 namespace Ui {
@@ -46,8 +49,8 @@ public:
     explicit FcodeMonitorDialog(QWidget *parent = 0);
     ~FcodeMonitorDialog();
 
-    void putData(const QByteArray &data, bool timeStamp);
-    void putResponse(const QByteArray &data, bool timeStamp);
+    void putData(const QByteArray &data, bool timeStamp, qint64 arrivalNs);
+    void putResponse(const QByteArray &data, bool timeStamp, qint64 arrivalNs);
 
 private slots:
     void on_clearButton_clicked();
@@ -0,0 +1,116 @@
+/************************************************************************
+
+    fcodequeue.cpp
+
+    Received F-code queue
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#include "fcodequeue.h"
+
+#include <cstring>
+
+FcodeQueue::FcodeQueue()
+{
+    head = 0;
+    tail = 0;
+
+    pushedThisRead = 0;
+    readCount = 0;
+    multiCommandReadCount = 0;
+    droppedCount = 0;
+}
+
+void FcodeQueue::beginRead(void)
+{
+    pushedThisRead = 0;
+}
+
+void FcodeQueue::endRead(void)
+{
+    readCount++;
+    if (pushedThisRead > 1) multiCommandReadCount++;
+}
+
+bool FcodeQueue::push(const char *text, size_t length, int64_t arrivalNs)
+{
+    if (head - tail == capacity) {
+        droppedCount++;
+        return false;
+    }
+
+    // Payloads from the tag demultiplexer always fit
+    if (length > TagDemux::maximumPayloadLength) length = TagDemux::maximumPayloadLength;
+
+    Command &command = commands[head % capacity];
+    memcpy(command.text, text, length);
+    command.length = length;
+    command.arrivalNs = arrivalNs;
+
+    head++;
+    pushedThisRead++;
+    return true;
+}
+
+const FcodeQueue::Command *FcodeQueue::front(void) const
+{
+    if (head == tail) return nullptr;
+    return &commands[tail % capacity];
+}
+
+void FcodeQueue::pop(void)
+{
+    if (head != tail) tail++;
+}
+
+size_t FcodeQueue::size(void) const
+{
+    return head - tail;
+}
+
+bool FcodeQueue::isEmpty(void) const
+{
+    return head == tail;
+}
+
+bool FcodeQueue::isFull(void) const
+{
+    return head - tail == capacity;
+}
+
+// Number of reads parsed
+uint64_t FcodeQueue::reads(void) const
+{
+    return readCount;
+}
+
+// Number of reads that completed more than one F-code
+uint64_t FcodeQueue::multiCommandReads(void) const
+{
+    return multiCommandReadCount;
+}
+
+// Number of F-codes lost because the queue was full
+uint64_t FcodeQueue::droppedCommands(void) const
+{
+    return droppedCount;
+}
@@ -0,0 +1,85 @@
+/************************************************************************
+
+    fcodequeue.h
+
+    Received F-code queue header
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#ifndef FCODEQUEUE_H
+#define FCODEQUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tagdemux.h"
+
+// Holds every F-code completed by a read, in order, until the emulation
+// has handled it.  Storage is a fixed ring, so queuing a command never
+// allocates; a reader that may complete more commands than the ring holds
+// must drain it when isFull() (push() only drops a command if it does
+// not).  The queue also counts how often a single read delivers more than
+// one command.
+class FcodeQueue
+{
+public:
+    static const size_t capacity = 32;
+
+    struct Command {
+        char text[TagDemux::maximumPayloadLength];
+        size_t length;
+        int64_t arrivalNs;
+    };
+
+    FcodeQueue();
+
+    // Bracket the parsing of one read so that bursts can be counted
+    void beginRead(void);
+    void endRead(void);
+
+    // Returns false (and counts the loss) if the queue is full
+    bool push(const char *text, size_t length, int64_t arrivalNs);
+
+    // Oldest command, or null if the queue is empty
+    const Command *front(void) const;
+    void pop(void);
+
+    size_t size(void) const;
+    bool isEmpty(void) const;
+    bool isFull(void) const;
+
+    uint64_t reads(void) const;
+    uint64_t multiCommandReads(void) const;
+    uint64_t droppedCommands(void) const;
+
+private:
+    Command commands[capacity];
+    size_t head;
+    size_t tail;
+
+    size_t pushedThisRead;
+    uint64_t readCount;
+    uint64_t multiCommandReadCount;
+    uint64_t droppedCount;
+};
+
+#endif // FCODEQUEUE_H
@@ -0,0 +1,189 @@
+/************************************************************************
+
+    fcodetable.h
+
+    F-code syntax table
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#ifndef FCODETABLE_H
+#define FCODETABLE_H
+
+#include "fcodedecoder.h"
+
+// The F-code grammar: one row per command form, taken from the command
+// descriptions in playeremulator.cpp.  Rows with the same leading character
+// must be kept together; within a group the first matching row wins.
+//
+// The suffix selects between rows with the same leading character.  It is
+// the second character of selector and overlay codes, the separator of a
+// jump (+ or -), and the last character of the other forms (0 for a number
+// with no suffix).  The X and Y limits are inclusive; a number may have no
+// more digits than its maximum.  A command that breaks its limits is
+// answered with the row's negative acknowledge, if it has one.
+struct FcodeSyntax {
+    enum class shapeType : uint8_t {
+        none,               // Just the code character (e.g. X)
+        selector,           // Code and suffix (e.g. A1, ?F)
+        digitPair,          // Two decimal digits, x and y (!xy)
+        bytePair,           // Two raw characters, x and y (#xy)
+        number,             // Decimal x then the suffix (e.g. FxxxxxR, +yy)
+        numberJump,         // Decimal x, the suffix, decimal y (e.g. *xxxxx+yy)
+        timeCode,           // Minutes x and optional seconds y (TxxyyN)
+        chapterSequence,    // Up to seven chapters (QxxyyzzS)
+        overlay             // VP followed by a mode digit or X
+    };
+
+    char code;
+    char suffix;
+    shapeType shape;
+    int32_t minimumX;
+    int32_t maximumX;
+    int32_t minimumY;
+    int32_t maximumY;
+    FcodeCommand::opcodeType opcode;
+    const char *negativeAck;
+    const char *description;
+};
+
+using fcodeShape = FcodeSyntax::shapeType;
+using fcodeOp = FcodeCommand::opcodeType;
+
+constexpr FcodeSyntax fcodeTable[] = {
+    { '!',  0,   fcodeShape::digitPair,       0,    9,       0,    9,    fcodeOp::soundInsert,                   nullptr, "Sound insert" },
+    { '#',  0,   fcodeShape::bytePair,        0x40, 0x5F,    0x40, 0x7F, fcodeOp::rc5Output,                     nullptr, "RC-5 output via euroconnector" },
+    { '$',  '0', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::replaySwitchDisable,           nullptr, "Replay switch disable" },
+    { '$',  '1', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::replaySwitchEnable,            nullptr, "Replay switch enable" },
+    { '\'', 0,   fcodeShape::none,            0,    0,       0,    0,    fcodeOp::eject,                         nullptr, "Eject" },
+    { ')',  '0', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::transmissionDelayOff,          nullptr, "Transmission delay off" },
+    { ')',  '1', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::transmissionDelayOn,           nullptr, "Transmission delay on" },
+    { '*',  0,   fcodeShape::none,            0,    0,       0,    0,    fcodeOp::halt,                          nullptr, "Halt" },
+    { '*',  '+', fcodeShape::numberJump,      1,    99999,   1,    50,   fcodeOp::haltAndJumpForward,            nullptr, "Halt and jump forward" },
+    { '*',  '-', fcodeShape::numberJump,      1,    99999,   1,    50,   fcodeOp::haltAndJumpReverse,            nullptr, "Halt and jump reverse" },
+    { '+',  0,   fcodeShape::number,          1,    50,      0,    0,    fcodeOp::instantJumpForward,            nullptr, "Instant jump forward" },
+    { ',',  '0', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::standby,                       nullptr, "Standby" },
+    { ',',  '1', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::on,                            nullptr, "On" },
+    { '-',  0,   fcodeShape::number,          1,    50,      0,    0,    fcodeOp::instantJumpReverse,            nullptr, "Instant jump reverse" },
+    { '/',  0,   fcodeShape::none,            0,    0,       0,    0,    fcodeOp::pause,                         nullptr, "Pause" },
+    { ':',  0,   fcodeShape::none,            0,    0,       0,    0,    fcodeOp::resetToDefault,                nullptr, "Reset to default" },
+    { '?',  'F', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::pictureNumberRequest,          nullptr, "Picture number request" },
+    { '?',  'C', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::chapterNumberRequest,          nullptr, "Chapter number request" },
+    { '?',  'D', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::discProgramStatusRequest,      nullptr, "Disc program status request" },
+    { '?',  'P', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::playerStatusRequest,           nullptr, "Player status request" },
+    { '?',  'U', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::userCodeRequest,               nullptr, "User code request" },
+    { '?',  '=', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::revisionLevelRequest,          nullptr, "Revision level request" },
+    { 'A',  '0', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::audio1Off,                     nullptr, "Audio-1 off" },
+    { 'A',  '1', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::audio1On,                      nullptr, "Audio-1 on" },
+    { 'B',  '0', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::audio2Off,                     nullptr, "Audio-2 off" },
+    { 'B',  '1', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::audio2On,                      nullptr, "Audio-2 on" },
+    { 'C',  '0', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::chapterNumberDisplayOff,       nullptr, "Chapter number display off" },
+    { 'C',  '1', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::chapterNumberDisplayOn,        nullptr, "Chapter number display on" },
+    { 'D',  '0', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::pictureNumberDisplayOff,       nullptr, "Picture number display off" },
+    { 'D',  '1', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::pictureNumberDisplayOn,        nullptr, "Picture number display on" },
+    { 'E',  '0', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::videoOff,                      nullptr, "Video off" },
+    { 'E',  '1', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::videoOn,                       nullptr, "Video on" },
+    { 'F',  'I', fcodeShape::number,          0,    99999,   0,    0,    fcodeOp::loadPictureNumberInfoRegister, "AN",    "Load picture number info register" },
+    { 'F',  'S', fcodeShape::number,          0,    99999,   0,    0,    fcodeOp::loadPictureNumberStopRegister, "AN",    "Load picture number stop register" },
+    { 'F',  'R', fcodeShape::number,          0,    99999,   0,    0,    fcodeOp::gotoPictureNumberAndHalt,      "AN",    "Goto picture number and halt" },
+    { 'F',  'N', fcodeShape::number,          0,    99999,   0,    0,    fcodeOp::gotoPictureNumberAndPlay,      "AN",    "Goto picture number and play" },
+    { 'F',  'Q', fcodeShape::number,          0,    99999,   0,    0,    fcodeOp::gotoPictureNumberAndContinue,  "AN",    "Goto picture number and continue" },
+    { 'H',  '0', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::rcToComputerOff,               nullptr, "Remote control to computer off" },
+    { 'H',  '1', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::rcToComputerOn,                nullptr, "Remote control to computer on" },
+    { 'I',  '0', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::localControlOff,               nullptr, "Local front panel control off" },
+    { 'I',  '1', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::localControlOn,                nullptr, "Local front panel control on" },
+    { 'J',  '0', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::remoteControlOff,              nullptr, "Remote control off" },
+    { 'J',  '1', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::remoteControlOn,               nullptr, "Remote control on" },
+    { 'L',  0,   fcodeShape::none,            0,    0,       0,    0,    fcodeOp::stillForward,                  nullptr, "Still forward" },
+    { 'M',  0,   fcodeShape::none,            0,    0,       0,    0,    fcodeOp::stillReverse,                  nullptr, "Still reverse" },
+    { 'N',  0,   fcodeShape::none,            0,    0,       0,    0,    fcodeOp::playForward,                   nullptr, "Play forward" },
+    { 'N',  '+', fcodeShape::numberJump,      1,    99999,   1,    50,   fcodeOp::playForwardAndJumpForward,     nullptr, "Play forward and jump forward" },
+    { 'N',  '-', fcodeShape::numberJump,      1,    99999,   1,    50,   fcodeOp::playForwardAndJumpReverse,     nullptr, "Play forward and jump reverse" },
+    { 'O',  0,   fcodeShape::none,            0,    0,       0,    0,    fcodeOp::playReverse,                   nullptr, "Play reverse" },
+    { 'O',  '+', fcodeShape::numberJump,      1,    99999,   1,    50,   fcodeOp::playReverseAndJumpForward,     nullptr, "Play reverse and jump forward" },
+    { 'O',  '-', fcodeShape::numberJump,      1,    99999,   1,    50,   fcodeOp::playReverseAndJumpReverse,     nullptr, "Play reverse and jump reverse" },
+    { 'Q',  'R', fcodeShape::number,          0,    79,      0,    0,    fcodeOp::gotoChapterAndHalt,            "AN",    "Goto chapter and halt" },
+    { 'Q',  'N', fcodeShape::number,          0,    79,      0,    0,    fcodeOp::gotoChapterAndPlay,            "AN",    "Goto chapter and play" },
+    { 'Q',  'S', fcodeShape::chapterSequence, 0,    79,      0,    0,    fcodeOp::playChapterSequence,           "AN",    "Play chapter sequence" },
+    { 'R',  '0', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::slowRead,                      nullptr, "Slow read" },
+    { 'R',  '1', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::fastRead,                      nullptr, "Fast read" },
+    { 'S',  'F', fcodeShape::number,          2,    40,      0,    0,    fcodeOp::setFastSpeed,                  nullptr, "Set fast speed" },
+    { 'S',  'S', fcodeShape::number,          2,    250,     0,    0,    fcodeOp::setSlowSpeed,                  nullptr, "Set slow speed" },
+    { 'S',  0,   fcodeShape::number,          2,    250,     0,    0,    fcodeOp::setSlowSpeed,                  nullptr, "Set slow speed" },
+    { 'T',  'N', fcodeShape::timeCode,        0,    99,      0,    59,   fcodeOp::gotoTimeCode,                  "AN",    "Goto time code" },
+    { 'T',  'I', fcodeShape::timeCode,        0,    99,      0,    59,   fcodeOp::loadTimeCodeInfoRegister,      "AN",    "Load time code info register" },
+    { 'U',  0,   fcodeShape::none,            0,    0,       0,    0,    fcodeOp::slowMotionForward,             nullptr, "Slow motion forward" },
+    { 'V',  0,   fcodeShape::none,            0,    0,       0,    0,    fcodeOp::slowMotionReverse,             nullptr, "Slow motion reverse" },
+    { 'V',  'P', fcodeShape::overlay,         1,    5,       0,    0,    fcodeOp::videoOverlay,                  nullptr, "Video overlay" },
+    { 'W',  0,   fcodeShape::none,            0,    0,       0,    0,    fcodeOp::fastForward,                   nullptr, "Fast forward" },
+    { 'X',  0,   fcodeShape::none,            0,    0,       0,    0,    fcodeOp::clear,                         nullptr, "Clear" },
+    { 'Z',  0,   fcodeShape::none,            0,    0,       0,    0,    fcodeOp::fastReverse,                   nullptr, "Fast reverse" },
+    { '[',  '0', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::audio1FromInternal,            nullptr, "Audio-1 from internal" },
+    { '[',  '1', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::audio1FromExternal,            nullptr, "Audio-1 from external" },
+    { '\\', '0', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::videoFromInternal,             nullptr, "Video from internal" },
+    { '\\', '1', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::videoFromExternal,             nullptr, "Video from external" },
+    { ']',  '0', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::audio2FromInternal,            nullptr, "Audio-2 from internal" },
+    { ']',  '1', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::audio2FromExternal,            nullptr, "Audio-2 from external" },
+    { '_',  '0', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::txtFromDiscOff,                nullptr, "Teletext from disc off" },
+    { '_',  '1', fcodeShape::selector,        0,    0,       0,    0,    fcodeOp::txtFromDiscOn,                 nullptr, "Teletext from disc on" }
+};
+
+constexpr size_t fcodeTableSize = sizeof(fcodeTable) / sizeof(fcodeTable[0]);
+
+// Rows for each leading character, built at compile time so that finding
+// the candidate rows for an F-code is a single array index
+struct FcodeIndex {
+    uint8_t first[128];
+    uint8_t count[128];
+};
+
+constexpr FcodeIndex buildFcodeIndex(void)
+{
+    FcodeIndex index {};
+
+    for (size_t row = 0; row < fcodeTableSize; row++) {
+        size_t code = static_cast<unsigned char>(fcodeTable[row].code);
+        if (index.count[code] == 0) index.first[code] = static_cast<uint8_t>(row);
+        index.count[code]++;
+    }
+
+    return index;
+}
+
+// True if the rows for each leading character are next to each other
+constexpr bool fcodeTableIsGrouped(void)
+{
+    for (size_t row = 1; row < fcodeTableSize; row++) {
+        for (size_t earlier = 0; earlier + 1 < row; earlier++) {
+            if (fcodeTable[earlier].code == fcodeTable[row].code
+                    && fcodeTable[row - 1].code != fcodeTable[row].code) return false;
+        }
+    }
+
+    return true;
+}
+
+constexpr FcodeIndex fcodeIndex = buildFcodeIndex();
+
+static_assert(fcodeTableSize < 256, "F-code table is too large for its index");
+static_assert(fcodeTableIsGrouped(), "F-code table rows must be grouped by leading character");
+
+#endif // FCODETABLE_H
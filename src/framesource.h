@@ -0,0 +1,60 @@
+/************************************************************************
+
+    framesource.h
+
+    Frame source interface header
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#ifndef FRAMESOURCE_H
+#define FRAMESOURCE_H
+
+#include <QtGlobal>
+#include <QString>
+
+// The player emulation reads and moves the disc position through a frame
+// source.  The frame viewer dialogue plays the disc image on screen; the
+// virtual frame source keeps time without decoding any video, so that
+// players hosted in worker threads do not need a widget.
+class FrameSource
+{
+public:
+    virtual ~FrameSource() {}
+
+    virtual void loadDiscImage(QString fileName) = 0;
+    virtual void setFrame(qint64 frameNumber) = 0;
+    virtual qint64 getFrame() = 0;
+    virtual void play() = 0;
+    virtual void pause() = 0;
+    virtual bool isPlaying() = 0;
+
+    // Whole fields the current frame has been showing for while playing
+    // at normal speed (0 or 1), so that the next frame change can be
+    // timed from the start of this one
+    virtual qint64 fieldsIntoFrame() = 0;
+
+    // Playback forward holds on the stop frame (0 for none), so frames
+    // past it are never shown
+    virtual void setStopFrame(qint64 frameNumber) = 0;
+};
+
+#endif // FRAMESOURCE_H
@@ -42,6 +42,12 @@ FrameViewerDialog::FrameViewerDialog(QWidget *parent) :
 
     // Attach a media player to the video widget
     player = new QMediaPlayer(ui->videoWidget);
+
+    // Watch the position every field so that playback can be held on the
+    // stop frame
+    stopMs = -1;
+    player->setNotifyInterval(20);
+    connect(player, &QMediaPlayer::positionChanged, this, &FrameViewerDialog::positionChanged);
 }
 
 FrameViewerDialog::~FrameViewerDialog()
@@ -86,6 +92,13 @@ void FrameViewerDialog::play()
     if (player->state() != QMediaPlayer::PlayingState) player->play();
 }
 
+// Each 40 ms frame is shown for two 20 ms fields
+qint64 FrameViewerDialog::fieldsIntoFrame()
+{
+    if (!isPlaying()) return 0;
+    return (player->position() % 40) / 20;
+}
+
 // Pause on current frame
 void FrameViewerDialog::pause()
 {
@@ -103,6 +116,24 @@ bool FrameViewerDialog::isPlaying()
     return playerStatus;
 }
 
+// Hold playback on a frame (a frame that has already been passed is ignored)
+void FrameViewerDialog::setStopFrame(qint64 frameNumber)
+{
+    qint64 msPosition = (frameNumber - 1) * 40;
+
+    stopMs = (frameNumber > 0 && player->position() <= msPosition) ? msPosition : -1;
+}
+
+// Pause on the stop frame as soon as playback reaches it
+void FrameViewerDialog::positionChanged(qint64 position)
+{
+    if (stopMs < 0 || position < stopMs || player->state() != QMediaPlayer::PlayingState) return;
+
+    player->pause();
+    player->setPosition(stopMs);
+    stopMs = -1;
+}
+
 // Mouse click event on the video player
 void FrameViewerDialog::mouseDoubleClickEvent(QMouseEvent* event)
 {
@@ -35,12 +35,13 @@
 #include <QMouseEvent>
 
 #include "ui_frameviewerdialog.h"
+#include "framesource.h"
 
 namespace Ui {
 class FrameViewerDialog;
 }
 
-class FrameViewerDialog : public QDialog
+class FrameViewerDialog : public QDialog, public FrameSource
 {
     Q_OBJECT
 
@@ -48,20 +49,24 @@ public:
     explicit FrameViewerDialog(QWidget *parent = 0);
     ~FrameViewerDialog();
 
-    void loadDiscImage(QString fileName);
-    void setFrame(qint64 frameNumber);
-    qint64 getFrame();
-    void play();
-    void pause();
-    bool isPlaying();
+    void loadDiscImage(QString fileName) override;
+    void setFrame(qint64 frameNumber) override;
+    qint64 getFrame() override;
+    void play() override;
+    void pause() override;
+    bool isPlaying() override;
+    qint64 fieldsIntoFrame() override;
+    void setStopFrame(qint64 frameNumber) override;
 
 private slots:
     void mouseDoubleClickEvent(QMouseEvent *);
+    void positionChanged(qint64 position);
 
 private:
     Ui::FrameViewerDialog *ui;
 
     QMediaPlayer *player;
+    qint64 stopMs;
 };
 
 #endif // FRAMEVIEWERDIALOG_H
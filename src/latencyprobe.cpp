@@ -0,0 +1,118 @@
+/************************************************************************
+
+    latencyprobe.cpp
+
+    Transport receive latency probe functions
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#include "latencyprobe.h"
+#include "transport.h"
+
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QTimer>
+#include <QVector>
+
+#include <algorithm>
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+qint64 LatencyProbe::measureReceiveLatency(SettingsDialog::Settings settings, int samples, QString &error)
+{
+#ifdef Q_OS_UNIX
+    // Create a pseudo-terminal pair; the transport opens the slave side as
+    // if it was a serial port and the probe writes to the master side
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        error = QObject::tr("Could not create a pseudo-terminal");
+        if (master >= 0) ::close(master);
+        return -1;
+    }
+
+    // Pass bytes straight through the pair
+    struct termios tio;
+    tcgetattr(master, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(master, TCSANOW, &tio);
+
+    settings.name = QString::fromLocal8Bit(ptsname(master));
+
+    Transport *transport = Transport::create(settings);
+    if (!transport->open()) {
+        error = transport->errorString();
+        delete transport;
+        ::close(master);
+        return -1;
+    }
+
+    QEventLoop loop;
+    QTimer timeout;
+    timeout.setSingleShot(true);
+    QObject::connect(transport, &Transport::readyRead, &loop, &QEventLoop::quit);
+    QObject::connect(&timeout, &QTimer::timeout, &loop, &QEventLoop::quit);
+
+    QElapsedTimer clock;
+    clock.start();
+    QVector<qint64> results;
+
+    for (int sample = 0; sample < samples; sample++) {
+        const char probe = 'X';
+
+        qint64 sent = clock.nsecsElapsed();
+        if (::write(master, &probe, 1) != 1) break;
+
+        // Wait for the transport to report the byte
+        timeout.start(1000);
+        loop.exec();
+        qint64 arrived = clock.nsecsElapsed();
+        timeout.stop();
+
+        if (transport->readAll().isEmpty()) {
+            error = QObject::tr("Timed out waiting for the transport");
+            break;
+        }
+
+        results.append((arrived - sent) / 1000);
+    }
+
+    transport->close();
+    delete transport;
+    ::close(master);
+
+    if (results.isEmpty()) return -1;
+
+    // Report the median so that the odd scheduling hiccup does not dominate
+    std::sort(results.begin(), results.end());
+    return results[results.size() / 2];
+#else
+    Q_UNUSED(settings);
+    Q_UNUSED(samples);
+    error = QObject::tr("Latency measurement needs a pseudo-terminal (Unix only)");
+    return -1;
+#endif
+}
@@ -1,8 +1,8 @@
 /************************************************************************
 
-    fcodeanalyser.h
+    latencyprobe.h
 
-    F-Code analyser function header
+    Transport receive latency probe function header
     VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
     Copyright (C) 2017 Simon Inns
 
@@ -25,25 +25,21 @@
 
 ************************************************************************/
 
-#ifndef FCODEANALYSER_H
-#define FCODEANALYSER_H
+#ifndef LATENCYPROBE_H
+#define LATENCYPROBE_H
 
 #include <QString>
-#include <QByteArray>
-#include <QDebug>
 
-class FcodeAnalyser
+#include "settingsdialog.h"
+
+// Measures how long a transport takes to report a byte written to the
+// other end of a pseudo-terminal pair, so serial backends can be compared
+// without any hardware attached.
+class LatencyProbe
 {
 public:
-    FcodeAnalyser();
-
-    void putData(const QByteArray &data);
-    QByteArray getFcode(void);
-
-private:
-    QString fcodeBuffer;
-
-    QString lastFcode;
+    // Returns the median receive latency in microseconds, or -1 on failure
+    static qint64 measureReceiveLatency(SettingsDialog::Settings settings, int samples, QString &error);
 };
 
-#endif // FCODEANALYSER_H
+#endif // LATENCYPROBE_H
@@ -26,13 +26,81 @@
 ************************************************************************/
 
 #include "mainwindow.h"
+#include "faultinjector.h"
 #include <QApplication>
+#include <QCommandLineParser>
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+
+    // Used by QSettings to store the serial configuration between runs
+    QCoreApplication::setOrganizationName("VP415Emu");
+    QCoreApplication::setApplicationName("VP415Emu");
+
+    // Process the command line options
+    QCommandLineParser parser;
+    parser.setApplicationDescription("VP415Emu - VP415 LaserDisc player emulator for BeebSCSI");
+    parser.addHelpOption();
+
+    QCommandLineOption ptyOption("pty", QCoreApplication::translate("main", "Create a pseudo-terminal for a BeebSCSI stand-in and print its path"));
+    parser.addOption(ptyOption);
+
+    QCommandLineOption localSocketOption("local-socket", QCoreApplication::translate("main", "Listen for a BBC Micro emulator on the local socket <name>"), "name");
+    parser.addOption(localSocketOption);
+
+    QCommandLineOption tcpPortOption("tcp-port", QCoreApplication::translate("main", "Listen for a BBC Micro emulator on localhost TCP <port>"), "port");
+    parser.addOption(tcpPortOption);
+
+    QCommandLineOption shmOption("shm", QCoreApplication::translate("main", "Create the shared memory channel <name> (see vp415shm.h) for a co-located emulator"), "name");
+    parser.addOption(shmOption);
+
+    QCommandLineOption faultsOption("faults", QCoreApplication::translate("main", "Inject link faults, e.g. seed=1,latency=20,jitter=5,drop=0.01,corrupt=0.01,split=0.1"), "spec");
+    parser.addOption(faultsOption);
+
+    QCommandLineOption playerOption("player", QCoreApplication::translate("main", "Host an additional player on <transport>[:<address>][,<disc image>] (serial, termios, pty, local, tcp or shm); may be repeated"), "spec");
+    parser.addOption(playerOption);
+
+    QCommandLineOption turboOption("turbo", QCoreApplication::translate("main", "Run hosted players on virtual time, skipping ahead whenever the host is idle (for automated test runs)"));
+    parser.addOption(turboOption);
+
+    parser.process(a);
+
     MainWindow w;
     w.show();
 
+    // Stress the host's retry logic with a slow or lossy link
+    if (parser.isSet(faultsOption)) {
+        SettingsDialog::FaultSettings faults = { false, 1, 0, 0, 0.0, 0.0, 0.0 };
+        QString error;
+
+        if (!FaultInjector::parseSpecification(parser.value(faultsOption), faults, error)) {
+            qCritical() << error;
+            return 1;
+        }
+        w.setFaultSettings(faults);
+    }
+
+    // Connect to a local pseudo-terminal or socket rather than waiting for
+    // the user to select a COM port
+    bool connected = true;
+    if (parser.isSet(ptyOption)) {
+        connected = w.connectLocalEndpoint(SettingsDialog::transportType::pseudoTerminal, QString());
+    } else if (parser.isSet(localSocketOption)) {
+        connected = w.connectLocalEndpoint(SettingsDialog::transportType::localSocket, parser.value(localSocketOption));
+    } else if (parser.isSet(tcpPortOption)) {
+        connected = w.connectLocalEndpoint(SettingsDialog::transportType::tcpSocket, parser.value(tcpPortOption));
+    } else if (parser.isSet(shmOption)) {
+        connected = w.connectLocalEndpoint(SettingsDialog::transportType::sharedMemory, parser.value(shmOption));
+    }
+    if (!connected) return 1;
+
+    // Host any additional players requested
+    w.setTurboMode(parser.isSet(turboOption));
+    const QStringList players = parser.values(playerOption);
+    for (const QString &specification : players) {
+        if (!w.addHostedPlayer(specification)) return 1;
+    }
+
     return a.exec();
 }
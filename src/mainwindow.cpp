@@ -33,8 +33,14 @@ MainWindow::MainWindow(QWidget *parent) :
 {
     ui->setupUi(this);
 
-    // Define the serial port
-    serial = new QSerialPort(this);
+    // Define the serial I/O worker and run it in its own thread so that
+    // serial traffic is not held up by the GUI
+    ioThread = new QThread(this);
+    ioWorker = new SerialIoWorker;
+    ioWorker->moveToThread(ioThread);
+    connect(ioThread, &QThread::finished, ioWorker, &QObject::deleteLater);
+    ioThread->start(QThread::TimeCriticalPriority);
+    connected = false;
 
     // Set the window's title
     this->setWindowTitle(tr("BeebSCSI - Philips VP415 LaserVision Disc Player Emulator"));
@@ -48,6 +54,10 @@ MainWindow::MainWindow(QWidget *parent) :
     // Create the F-code monitoring dialogue
     fcodeMonitor = new FcodeMonitorDialog;
 
+    // Additional players hosted by this process run on a pool of threads
+    sessionPool = new SessionPool(0, this);
+    playersDialog = new PlayersDialog(sessionPool);
+
     // Enable and disable menu options as appropriate
     ui->actionConnect->setEnabled(true);
     ui->actionDisconnect->setEnabled(false);
@@ -61,25 +71,49 @@ MainWindow::MainWindow(QWidget *parent) :
     // Set the status
     status->setText(tr("Select a COM port..."));
 
-    // Connect the serial port signals to catch errors
-    connect(serial, static_cast<void (QSerialPort::*)(QSerialPort::SerialPortError)>(&QSerialPort::error), this, &MainWindow::handleError);
-
-    // Connect the serial read and write signals to the main window
-    connect(serial, &QSerialPort::readyRead, this, &MainWindow::readData);
-
-    // Create the fcodeAnalyser object
-    fcodeAnalyser = new FcodeAnalyser;
-
-    // Create the userCodeAnalyser object
-    userCodeAnalyser = new UserCodeAnalyser;
+    // Add a label to the status bar for showing the output queue counters
+    linkStatus = new QLabel;
+    ui->statusBar->addPermanentWidget(linkStatus);
+    lastBytesReceived = 0;
+    lastBytesSent = 0;
+    throughputText = tr("Rx: - B/s  Tx: - B/s");
+
+    // Connect the serial I/O worker signals to catch errors
+    connect(ioWorker, &SerialIoWorker::portError, this, &MainWindow::handleError);
+
+    // Connect the serial receive signal to the main window
+    connect(ioWorker, &SerialIoWorker::dataReceived, this, &MainWindow::readData);
+
+    // Create the tag demultiplexer that picks user codes and F-codes out of
+    // the BeebSCSI serial stream; F-codes are queued so that every command
+    // in a read is handled in order
+    tagDemux = new TagDemux;
+    fcodeQueue = new FcodeQueue;
+    tagDemux->addTag("UCD", [this](const char *payload, size_t length) {
+        handleUserCode(QByteArray(payload, static_cast<int>(length)));
+    });
+    tagDemux->addTag("FCODE", [this](const char *payload, size_t length) {
+        if (length == 0) return;
+
+        // A large read can complete more F-codes than the queue holds, so
+        // the queued ones are handled first rather than dropping any
+        if (fcodeQueue->isFull()) handleQueuedFcodes();
+        fcodeQueue->push(payload, length, chunkArrivalNs);
+    });
+    chunkArrivalNs = 0;
+    lastDispatchNs = 0;
+    maxDispatchNs = 0;
 
     // Create the player emulation object
     player = new PlayerEmulator;
 
-    // Set up a timer to poll the player emulation 25 times a second
-    QTimer *playerTimer = new QTimer(this);
-    connect(playerTimer, SIGNAL(timeout()), this, SLOT(pollPlayerEmulation()));
-    playerTimer->start(40); // Call 25 times per second (1000 / 25 = 40)
+    // Poll the player emulation every PAL field (50 times a second) from
+    // the emulation clock
+    emulationClock = new EmulationClock(this);
+    lastPolledField = -1;
+    player->setClock(emulationClock);
+    connect(emulationClock, &EmulationClock::fieldTick, this, &MainWindow::pollPlayerEmulation);
+    emulationClock->startClock();
 }
 
 MainWindow::~MainWindow()
@@ -87,43 +121,126 @@ MainWindow::~MainWindow()
     delete ui;
 }
 
-// Function to open a serial port
-void MainWindow::openSerialPort()
+// Inject link faults on every connection from now on (used by the command
+// line options)
+void MainWindow::setFaultSettings(const SettingsDialog::FaultSettings &faults)
+{
+    settings->setFaultSettings(faults);
+}
+
+// Run the hosted players on virtual time, skipping the waits for searches
+// and play whenever their hosts are idle (used by the command line options)
+void MainWindow::setTurboMode(bool enabled)
+{
+    sessionPool->setVirtualTime(enabled);
+}
+
+// Host another player on its own transport (used by the command line
+// options)
+bool MainWindow::addHostedPlayer(const QString &specification)
+{
+    SettingsDialog::Settings p = settings->settings();
+    QString discImage;
+    QString error;
+
+    if (!PlayerSession::parseSpecification(specification, p, discImage, error) ||
+            !sessionPool->addSession(p, discImage, error)) {
+        qCritical() << "Unable to start hosted player:" << error;
+        return false;
+    }
+
+    // Print the endpoint so that scripts can find it
+    QTextStream out(stdout);
+    out << "VP415Emu player " << sessionPool->count() << ": " << sessionPool->status(sessionPool->count() - 1).endpoint << "\n";
+    out.flush();
+    return true;
+}
+
+// Create a pseudo-terminal or socket and wait for a BeebSCSI stand-in to
+// connect to it (used by the command line options)
+bool MainWindow::connectLocalEndpoint(SettingsDialog::transportType transport, const QString &address)
 {
     SettingsDialog::Settings p = settings->settings();
+    p.transport = transport;
+    p.address = address;
+
+    if (!openSerialPort(p)) return false;
+
+    // Print the endpoint so that scripts can find it
+    QTextStream out(stdout);
+    if (transport == SettingsDialog::transportType::pseudoTerminal) out << "VP415Emu pseudo-terminal: ";
+    else if (transport == SettingsDialog::transportType::sharedMemory) out << "VP415Emu shared memory: ";
+    else out << "VP415Emu socket: ";
+    out << ioWorker->endpointName() << "\n";
+    out.flush();
+    return true;
+}
 
-    // Verify that a COM port has been selected
-    if (p.name.isEmpty()) {
-        QMessageBox::warning(this, tr("VP415Emu warning"), tr("You must select a COM port before connecting"));
-        return;
+// Function to open a serial port
+bool MainWindow::openSerialPort(const SettingsDialog::Settings &p)
+{
+    // Verify that a COM port or socket has been selected
+    switch (p.transport) {
+        case SettingsDialog::transportType::pseudoTerminal:
+        case SettingsDialog::transportType::sharedMemory:
+        break;
+
+        case SettingsDialog::transportType::localSocket:
+        case SettingsDialog::transportType::tcpSocket:
+        if (p.address.isEmpty()) {
+            QMessageBox::warning(this, tr("VP415Emu warning"), tr("You must enter a socket name or port before connecting"));
+            return false;
+        }
+        break;
+
+        default:
+        if (p.name.isEmpty()) {
+            QMessageBox::warning(this, tr("VP415Emu warning"), tr("You must select a COM port before connecting"));
+            return false;
+        }
+        break;
     }
 
-    serial->setPortName(p.name);
-    serial->setBaudRate(p.baudRate);
-    serial->setDataBits(p.dataBits);
-    serial->setParity(p.parity);
-    serial->setStopBits(p.stopBits);
-    serial->setFlowControl(p.flowControl);
+    // Open the serial port in the I/O thread and wait for the result
+    bool opened = false;
+    ioWorker->setSettings(p);
+    QMetaObject::invokeMethod(ioWorker, "openPort", Qt::BlockingQueuedConnection, Q_RETURN_ARG(bool, opened));
+
+    if (opened) {
+        connected = true;
+
+        // Restart the throughput measurement
+        throughputTimer.invalidate();
+        throughputText = tr("Rx: - B/s  Tx: - B/s");
+
+        // Start parsing the new connection from a clean state
+        tagDemux->reset();
+        tagDemux->resetCounters();
+        lastDispatchNs = 0;
+        maxDispatchNs = 0;
 
-    if (serial->open(QIODevice::ReadWrite)) {
         // Enable and disable the UI as appropriate
         ui->actionConnect->setEnabled(false);
         ui->actionDisconnect->setEnabled(true);
         ui->actionSettings->setEnabled(false);
 
         // Show status in the status bar
-        status->setText(tr("Connected to BeebSCSI on ") + p.name);
-    } else {
-        QMessageBox::critical(this, tr("Error"), serial->errorString());
-        status->setText(tr("Error connecting to BeebSCSI"));
+        status->setText(tr("Connected to BeebSCSI on ") + ioWorker->endpointName());
+        emulationClock->wake();
+        return true;
     }
+
+    QMessageBox::critical(this, tr("Error"), ioWorker->errorString());
+    status->setText(tr("Error connecting to BeebSCSI"));
+    return false;
 }
 
 // Function to close a serial port
 void MainWindow::closeSerialPort()
 {
     // If the serial port is open, close it
-    if (serial->isOpen()) serial->close();
+    if (connected) QMetaObject::invokeMethod(ioWorker, "closePort", Qt::BlockingQueuedConnection);
+    connected = false;
 
     // Enable and disable the UI as appropriate
     ui->actionConnect->setEnabled(true);
@@ -132,53 +249,89 @@ void MainWindow::closeSerialPort()
 
     // Set the status to disconnected
     status->setText(tr("Disconnected from BeebSCSI"));
+    emulationClock->wake();
 }
 
 // Handle an error signal from the serial port
-void MainWindow::handleError(QSerialPort::SerialPortError error)
+void MainWindow::handleError(QString error)
 {
-    // If we receive a critical error from the serial port, close it cleanly
-    if (error == QSerialPort::ResourceError) {
-        // Pop up a message box showing the error
-        QMessageBox::critical(this, tr("Critical error from serial port"), serial->errorString());
-        closeSerialPort();
-    }
+    // The I/O worker only reports critical errors; close the port cleanly
+    // first so the link is released even while the message box is showing
+    closeSerialPort();
+
+    // Pop up a message box showing the error
+    QMessageBox::critical(this, tr("Critical error from serial port"), error);
 }
 
 // Function to write console data to the serial port
-void MainWindow::writeData(const QByteArray &data)
+void MainWindow::writeData(const QByteArray &data, bool paced, qint64 arrivalNs)
 {
-    serial->write(data);
+    if (connected) ioWorker->queueResponse(data, paced, arrivalNs);
 }
 
 // Function to write serial data to the console
 void MainWindow::readData()
 {
-    // Read all available data from the serial port
-    QByteArray data = serial->readAll();
-
-    // Send the received data to the serial monitor dialogue
-    serialMonitor->putData(data, ui->actionTime_stamp->isChecked());
-
-    // Check the serial data for a valid user code string from BeebSCSI
-    userCodeAnalyser->putData(data);
-    QByteArray userCode = userCodeAnalyser->getUserCode();
-    if (!userCode.isEmpty()) {
-        // Give the user code to the player emulation
-        qDebug() << "Got usercode from BeebSCSI = " << QString(userCode);
-        player->receiveUserCode(userCode);
+    QByteArray data;
+    qint64 arrivalNs;
+
+    // Keep the emulation ticking while the host is talking
+    emulationClock->wake();
+
+    // Drain all of the data received by the I/O thread
+    while (ioWorker->readChunk(data, arrivalNs)) {
+        // Send the received data to the serial monitor dialogue
+        serialMonitor->putData(data, ui->actionTime_stamp->isChecked(), arrivalNs);
+
+        // Scan the serial data for user codes and F-codes; the handlers
+        // are called for every complete message in the data
+        chunkArrivalNs = arrivalNs;
+        fcodeQueue->beginRead();
+        tagDemux->putData(data.constData(), static_cast<size_t>(data.size()));
+        fcodeQueue->endRead();
+
+        handleQueuedFcodes();
+    }
+
+    // Send any responses immediately rather than waiting for the next poll
+    sendFcodeResponses();
+}
+
+// Handle every queued F-code in order, sending its responses before the
+// next F-code is handled
+void MainWindow::handleQueuedFcodes()
+{
+    while (const FcodeQueue::Command *command = fcodeQueue->front()) {
+        handleFcode(QByteArray(command->text, static_cast<int>(command->length)), command->arrivalNs);
+        fcodeQueue->pop();
+        sendFcodeResponses();
     }
+}
 
-    // Check the serial data for a valid F-code command string
-    fcodeAnalyser->putData(data);
+// Handle a <UCD> user code from BeebSCSI
+void MainWindow::handleUserCode(const QByteArray &userCode)
+{
+    if (userCode.isEmpty()) return;
 
-    // Check the serial stream for an Fcode and output any codes to the fcode monitor
-    QByteArray fcode = fcodeAnalyser->getFcode();
+    // Give the user code to the player emulation
+    qDebug() << "Got usercode from BeebSCSI = " << QString(userCode);
+    player->receiveUserCode(userCode);
+}
 
-    if (!fcode.isEmpty()) fcodeMonitor->putData(fcode, ui->actionTime_stamp->isChecked());
+// Handle an <FCODE> command from BeebSCSI
+void MainWindow::handleFcode(const QByteArray &fcode, qint64 arrivalNs)
+{
+    // Output the F-code to the fcode monitor
+    fcodeMonitor->putData(fcode, ui->actionTime_stamp->isChecked(), arrivalNs);
+
+    // Note how long the F-code took to get here from the transport's read
+    if (arrivalNs > 0) {
+        lastDispatchNs = MonotonicClock::nowNs() - arrivalNs;
+        if (lastDispatchNs > maxDispatchNs) maxDispatchNs = lastDispatchNs;
+    }
 
-    // Pass any received F-codes to the player emulator
-    if (!fcode.isEmpty()) player->receiveFcode(QByteArray(fcode));
+    // Pass the F-code to the player emulator
+    player->receiveFcode(fcode, arrivalNs);
 }
 
 // Trigged by user clicking on X to close the window
@@ -191,13 +344,23 @@ void MainWindow::closeEvent(QCloseEvent *event)
 // File->Quit triggered
 void MainWindow::on_actionQuit_triggered()
 {
-    // If the serial port is open, close it
-    if (serial->isOpen()) serial->close();
+    // If the serial port is open, close it and stop the I/O thread
+    if (connected) QMetaObject::invokeMethod(ioWorker, "closePort", Qt::BlockingQueuedConnection);
+    connected = false;
+    ioThread->quit();
+    ioThread->wait();
+
+    // Stop the field ticks
+    emulationClock->stopClock();
+
+    // Close the hosted players and stop their threads
+    sessionPool->stopAll();
 
     // Close any open dialogues
     settings->close();
     serialMonitor->close();
     fcodeMonitor->close();
+    playersDialog->close();
 
     // Time to go bye-bye...
     qApp->quit();
@@ -210,7 +373,7 @@ void MainWindow::on_actionConnect_triggered()
     settings->hide();
 
     // Open the serial port
-    openSerialPort();
+    openSerialPort(settings->settings());
 }
 
 // BeebSCSI->disconnect triggered
@@ -248,6 +411,7 @@ void MainWindow::on_actionOpen_disc_image_triggered()
 
     // Load the file into the frame viewer
     player->loadDiscImage(fileName);
+    emulationClock->wake();
 }
 
 // Open frame viewer dialogue
@@ -256,13 +420,45 @@ void MainWindow::on_actionFrame_viewer_triggered()
     player->showFrameViewer();
 }
 
+void MainWindow::on_actionHosted_players_triggered()
+{
+    playersDialog->show();
+}
+
 // Poll the emulation
-void MainWindow::pollPlayerEmulation()
+void MainWindow::pollPlayerEmulation(qint64 field)
 {
+    // Ticks are queued onto the GUI event loop, so after a stall (a window
+    // drag, a slow redraw) several can arrive together.  Poll once at the
+    // current field and drop the rest of the backlog.
+    if (field <= lastPolledField) return;
+    qint64 currentField = emulationClock->currentField();
+    if (currentField > field) field = currentField;
+    lastPolledField = field;
+    emulationClock->recordPoll(field);
+
     // Poll the player emulation
-    player->poll();
+    player->poll(field);
+
+    // Send any waiting F-code responses
+    sendFcodeResponses();
+
+    // Nothing changes while the player is halted with nothing scheduled
+    // and no response still being sent, so the clock can sleep until the
+    // next event (or until woken by received data)
+    bool idle = player->isIdle() && (!connected || ioWorker->outputQueueDepth() == 0);
 
-    // Update the UI
+    // The display only needs updating once per frame (two fields), and
+    // once more before sleeping
+    if (field % 2 != 0 && !idle) return;
+    updateDisplay();
+
+    if (idle) emulationClock->sleepUntil(player->nextEventField());
+}
+
+// Show the player state and link statistics
+void MainWindow::updateDisplay()
+{
     ui->playerFrameNumber->setText(player->getFrameNumber());
     ui->playerDirection->setText(player->getDirection());
     ui->playerStatus->setText(player->getStatus());
@@ -274,13 +470,59 @@ void MainWindow::pollPlayerEmulation()
     ui->playerVideoOverlay->setText(player->getVideoOverlayMode());
     ui->playerVideoOutput->setText(player->getVideoOutput());
 
-    // Send any waiting F-code responses
-    QByteArray response = player->sendFcodeResponse();
-    if (!response.isEmpty()) {
+    // Show whether the link is keeping up with the responses
+    if (connected) {
+        updateThroughput();
+        linkStatus->setText(tr("%1  Output queue: %2 bytes  Max stall: %3 ms  Response latency: %4 us (max %5 us)  Multi-F-code reads: %6  Dropped F-codes: %7  Discarded: %8 bytes (%9 malformed tags)  F-code dispatch: %10 us (max %11 us)  Field jitter: %12 us (max %13 us)")
+                            .arg(throughputText)
+                            .arg(ioWorker->outputQueueDepth())
+                            .arg(ioWorker->maximumStallMs())
+                            .arg(ioWorker->lastResponseLatencyUs())
+                            .arg(ioWorker->maximumResponseLatencyUs())
+                            .arg(fcodeQueue->multiCommandReads())
+                            .arg(fcodeQueue->droppedCommands())
+                            .arg(tagDemux->discardedBytes())
+                            .arg(tagDemux->malformedTags())
+                            .arg(lastDispatchNs / 1000)
+                            .arg(maxDispatchNs / 1000)
+                            .arg(emulationClock->meanJitterUs())
+                            .arg(emulationClock->maximumJitterUs()));
+    } else {
+        linkStatus->clear();
+    }
+}
+
+// Measure the link throughput once a second
+void MainWindow::updateThroughput()
+{
+    qint64 elapsedMs = throughputTimer.elapsed();
+    if (throughputTimer.isValid() && elapsedMs < 1000) return;
+
+    qint64 received = ioWorker->totalBytesReceived();
+    qint64 sent = ioWorker->totalBytesSent();
+
+    if (throughputTimer.isValid()) {
+        throughputText = tr("Rx: %1 B/s  Tx: %2 B/s")
+                .arg((received - lastBytesReceived) * 1000 / elapsedMs)
+                .arg((sent - lastBytesSent) * 1000 / elapsedMs);
+    }
+
+    lastBytesReceived = received;
+    lastBytesSent = sent;
+    throughputTimer.start();
+}
+
+// Pass any waiting F-code responses to the I/O thread
+void MainWindow::sendFcodeResponses()
+{
+    qint64 arrivalNs;
+    QByteArray response;
+
+    while (!(response = player->sendFcodeResponse(arrivalNs)).isEmpty()) {
         // Send the response to the serial port
-        fcodeMonitor->putResponse(response, ui->actionTime_stamp->isChecked());
+        fcodeMonitor->putResponse(response, ui->actionTime_stamp->isChecked(), arrivalNs);
         qDebug() << "Sending F-code response via serial " << response;
-        writeData(response + "\r");
+        writeData(response + "\r", player->isTransmissionDelayOn(), arrivalNs);
     }
 }
 
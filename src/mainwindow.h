@@ -36,15 +36,22 @@
 #include <QLabel>
 #include <QCloseEvent>
 #include <QTimer>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QTextStream>
 #include <QDebug>
 
 #include "ui_mainwindow.h"
 #include "settingsdialog.h"
 #include "serialmonitordialog.h"
 #include "fcodemonitordialog.h"
-#include "fcodeanalyser.h"
-#include "usercodeanalyser.h"
+#include "tagdemux.h"
+#include "fcodequeue.h"
 #include "playeremulator.h"
+#include "serialioworker.h"
+#include "sessionpool.h"
+#include "playersdialog.h"
+#include "emulationclock.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -60,9 +67,9 @@ class Console;
 class SettingsDialog;
 class SerialMonitorDialog;
 class FcodeMonitorDialog;
-class FcodeAnalyser;
-class UserCodeAnalyser;
+class TagDemux;
 class PlayerEmulator;
+class SerialIoWorker;
 
 class MainWindow : public QMainWindow
 {
@@ -72,6 +79,11 @@ public:
     explicit MainWindow(QWidget *parent = 0);
     ~MainWindow();
 
+    void setFaultSettings(const SettingsDialog::FaultSettings &faults);
+    bool addHostedPlayer(const QString &specification);
+    void setTurboMode(bool enabled);
+    bool connectLocalEndpoint(SettingsDialog::transportType transport, const QString &address);
+
 private slots:
     void closeEvent(QCloseEvent *event);
 
@@ -81,41 +93,65 @@ private slots:
     void on_actionSettings_triggered();
     void on_actionAbout_triggered();
 
-    void handleError(QSerialPort::SerialPortError error);
+    void handleError(QString error);
 
     void on_actionSerial_console_triggered();
 
     void on_actionF_Code_console_triggered();
 
-    void pollPlayerEmulation();
+    void pollPlayerEmulation(qint64 field);
+    void readData();
 
     void on_actionFrame_viewer_triggered();
 
+    void on_actionHosted_players_triggered();
+
     void on_actionOpen_disc_image_triggered();
 
 private:
     Ui::MainWindow *ui;
 
-    void openSerialPort();
+    bool openSerialPort(const SettingsDialog::Settings &p);
     void closeSerialPort();
 
-    void writeData(const QByteArray &data);
-    void readData();
+    void writeData(const QByteArray &data, bool paced, qint64 arrivalNs);
+    void sendFcodeResponses();
+    void handleUserCode(const QByteArray &userCode);
+    void handleFcode(const QByteArray &fcode, qint64 arrivalNs);
+    void handleQueuedFcodes();
+    void updateThroughput();
+    void updateDisplay();
 
     QLabel *status;
+    QLabel *linkStatus;
+    QElapsedTimer throughputTimer;
+    qint64 lastBytesReceived;
+    qint64 lastBytesSent;
+    QString throughputText;
     Console *console;
+    SessionPool *sessionPool;
+    PlayersDialog *playersDialog;
     SettingsDialog *settings;
-    QSerialPort *serial;
+    QThread *ioThread;
+    SerialIoWorker *ioWorker;
+    bool connected;
 
     SerialMonitorDialog *serialMonitor;
     FcodeMonitorDialog *fcodeMonitor;
 
-    FcodeAnalyser *fcodeAnalyser;
-    UserCodeAnalyser *userCodeAnalyser;
+    TagDemux *tagDemux;
+    FcodeQueue *fcodeQueue;
+    qint64 chunkArrivalNs;
+
+    // Time from an F-code being read off the link to it reaching the player
+    qint64 lastDispatchNs;
+    qint64 maxDispatchNs;
 
     QString fileName;
 
     PlayerEmulator *player;
+    EmulationClock *emulationClock;
+    qint64 lastPolledField;
 };
 
 #endif // MAINWINDOW_H
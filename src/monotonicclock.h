@@ -0,0 +1,55 @@
+/************************************************************************
+
+    monotonicclock.h
+
+    Monotonic clock function header
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#ifndef MONOTONICCLOCK_H
+#define MONOTONICCLOCK_H
+
+#include <QtGlobal>
+#include <QTime>
+
+#include <chrono>
+
+// A process-wide monotonic clock shared by all threads, so that a time
+// stamped in the I/O thread can be compared with one taken in the GUI thread
+class MonotonicClock
+{
+public:
+    // Nanoseconds since an arbitrary fixed point
+    static qint64 nowNs(void)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Convert a monotonic time stamp to wall-clock time for display
+    static QTime toTime(qint64 timeNs)
+    {
+        return QTime::currentTime().addMSecs(static_cast<int>(-(nowNs() - timeNs) / 1000000));
+    }
+};
+
+#endif // MONOTONICCLOCK_H
@@ -0,0 +1,251 @@
+/************************************************************************
+
+    pacedwriter.cpp
+
+    Paced response writer functions
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#include "pacedwriter.h"
+#include "monotonicclock.h"
+
+PacedWriter::PacedWriter(QObject *parent) : QObject(parent)
+{
+    transport = nullptr;
+
+    // A precise single-shot timer is re-armed for each character deadline
+    timer = new QTimer(this);
+    timer->setTimerType(Qt::PreciseTimer);
+    timer->setSingleShot(true);
+    connect(timer, &QTimer::timeout, this, &PacedWriter::writeNext);
+
+    clock.start();
+    nextCharacterNs = 0;
+
+    pendingBytes = 0;
+    bytesInFlight = 0;
+    stallStartNs = 0;
+    queueDepth = 0;
+    maxStallNs = 0;
+    bytesSent = 0;
+
+    streamQueued = 0;
+    streamWritten = 0;
+    lastLatencyNs = 0;
+    maxLatencyNs = 0;
+}
+
+void PacedWriter::setTransport(Transport *newTransport)
+{
+    clear();
+    if (transport) disconnect(transport, nullptr, this, nullptr);
+
+    transport = newTransport;
+    bytesInFlight = 0;
+    updateDepth();
+
+    if (transport) connect(transport, &Transport::bytesWritten, this, &PacedWriter::transportBytesWritten);
+}
+
+// Bytes queued in the writer plus bytes the transport has not yet sent
+qint64 PacedWriter::queuedBytes(void) const
+{
+    return queueDepth.load(std::memory_order_relaxed);
+}
+
+// Longest time the transport has held data without sending any of it
+qint64 PacedWriter::maximumStallMs(void) const
+{
+    return maxStallNs.load(std::memory_order_relaxed) / 1000000;
+}
+
+// Bytes the transport has reported as sent since the writer was created
+qint64 PacedWriter::totalBytesWritten(void) const
+{
+    return bytesSent.load(std::memory_order_relaxed);
+}
+
+// Time from an F-code arriving to the end of its response being written
+qint64 PacedWriter::lastResponseLatencyUs(void) const
+{
+    return lastLatencyNs.load(std::memory_order_relaxed) / 1000;
+}
+
+qint64 PacedWriter::maximumResponseLatencyUs(void) const
+{
+    return maxLatencyNs.load(std::memory_order_relaxed) / 1000;
+}
+
+void PacedWriter::resetCounters(void)
+{
+    maxStallNs.store(0, std::memory_order_relaxed);
+    lastLatencyNs.store(0, std::memory_order_relaxed);
+    maxLatencyNs.store(0, std::memory_order_relaxed);
+}
+
+// Write data to the transport, paced at 50 char/s if required
+void PacedWriter::write(const QByteArray &data, bool paced, const QVector<Response> &responses)
+{
+    if (!transport || data.isEmpty()) return;
+
+    // Note where each response ends in the output stream
+    for (const Response &response : responses) {
+        Response queued = response;
+        queued.end += streamQueued;
+        pendingResponses.enqueue(queued);
+    }
+    streamQueued += data.size();
+
+    // Fast path: nothing queued ahead of this data and no delay required
+    if (!paced && segments.isEmpty()) {
+        writeToTransport(data);
+        return;
+    }
+
+    // Coalesce with the previous segment where possible so that unpaced
+    // responses queued behind paced data still go out in a single write
+    if (!segments.isEmpty() && segments.last().paced == paced) {
+        segments.last().data.append(data);
+    } else {
+        Segment segment;
+        segment.data = data;
+        segment.paced = paced;
+        segments.enqueue(segment);
+    }
+    pendingBytes += data.size();
+    updateDepth();
+
+    if (!timer->isActive()) schedule();
+}
+
+// Discard anything waiting to be sent
+void PacedWriter::clear(void)
+{
+    segments.clear();
+    timer->stop();
+
+    pendingResponses.clear();
+    streamQueued = streamWritten;
+
+    pendingBytes = 0;
+    updateDepth();
+}
+
+// Arm the timer for the next character (or write unpaced data now)
+void PacedWriter::schedule(void)
+{
+    if (segments.isEmpty()) return;
+
+    qint64 nowNs = clock.nsecsElapsed();
+
+    // Unpaced data queued behind paced data goes out as soon as it is
+    // reached; paced data waits for the next character slot
+    if (!segments.head().paced || nextCharacterNs <= nowNs) {
+        writeNext();
+        return;
+    }
+
+    // Round up so the timer never fires before the deadline
+    timer->start(static_cast<int>((nextCharacterNs - nowNs + 999999) / 1000000));
+}
+
+// Write the next character (or unpaced segment)
+void PacedWriter::writeNext(void)
+{
+    while (!segments.isEmpty() && transport) {
+        Segment &segment = segments.head();
+        qint64 nowNs = clock.nsecsElapsed();
+
+        if (!segment.paced) {
+            pendingBytes -= segment.data.size();
+            writeToTransport(segment.data);
+            segments.dequeue();
+            continue;
+        }
+
+        if (nextCharacterNs > nowNs) break;
+
+        pendingBytes--;
+        writeToTransport(segment.data.left(1));
+        segment.data.remove(0, 1);
+        if (segment.data.isEmpty()) segments.dequeue();
+
+        // Schedule from the previous deadline rather than from now so that
+        // the average rate stays at exactly 50 char/s; if the link has been
+        // idle, the next character may go immediately
+        if (nowNs - nextCharacterNs > characterIntervalNs) nextCharacterNs = nowNs;
+        nextCharacterNs += characterIntervalNs;
+    }
+
+    schedule();
+}
+
+// Hand data to the transport and start timing if the link was idle
+void PacedWriter::writeToTransport(const QByteArray &data)
+{
+    if (bytesInFlight == 0) stallStartNs = clock.nsecsElapsed();
+    bytesInFlight += data.size();
+    updateDepth();
+
+    // The transport may report progress before write() returns, so the
+    // data is counted in flight first and anything it did not accept (a
+    // failed write, or nobody to send to) is taken off again afterwards
+    qint64 accepted = transport->write(data);
+    if (accepted < 0) accepted = 0;
+    if (accepted < data.size()) {
+        bytesInFlight -= data.size() - accepted;
+        if (bytesInFlight < 0) bytesInFlight = 0;
+        updateDepth();
+    }
+    streamWritten += data.size();
+
+    // Record the latency of every response that is now completely written
+    qint64 nowNs = MonotonicClock::nowNs();
+    while (!pendingResponses.isEmpty() && pendingResponses.head().end <= streamWritten) {
+        qint64 latencyNs = nowNs - pendingResponses.dequeue().arrivalNs;
+        lastLatencyNs.store(latencyNs, std::memory_order_relaxed);
+        if (latencyNs > maxLatencyNs.load(std::memory_order_relaxed)) maxLatencyNs.store(latencyNs, std::memory_order_relaxed);
+    }
+}
+
+// The transport has sent some of the data in flight
+void PacedWriter::transportBytesWritten(qint64 bytes)
+{
+    qint64 nowNs = clock.nsecsElapsed();
+
+    // Record how long the transport held data before making progress
+    if (bytesInFlight > 0 && nowNs - stallStartNs > maxStallNs.load(std::memory_order_relaxed)) {
+        maxStallNs.store(nowNs - stallStartNs, std::memory_order_relaxed);
+    }
+
+    bytesSent.fetch_add(bytes, std::memory_order_relaxed);
+    bytesInFlight -= bytes;
+    if (bytesInFlight < 0) bytesInFlight = 0;
+    stallStartNs = nowNs;
+
+    updateDepth();
+}
+
+void PacedWriter::updateDepth(void)
+{
+    queueDepth.store(pendingBytes + bytesInFlight, std::memory_order_relaxed);
+}
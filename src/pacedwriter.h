@@ -0,0 +1,120 @@
+/************************************************************************
+
+    pacedwriter.h
+
+    Paced response writer function header
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#ifndef PACEDWRITER_H
+#define PACEDWRITER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QQueue>
+#include <QVector>
+
+#include <atomic>
+
+#include "transport.h"
+
+// Writes responses to the transport either immediately or, when the VP415
+// RS-232 transmission delay is on, one character every 20 ms (50 char/s).
+// Characters are scheduled against absolute deadlines so that timer
+// lateness does not accumulate over a long response.
+//
+// The writer also tracks the bytes handed to the transport that it has not
+// yet reported as written, so that a slow link shows up as queue depth and
+// stall time rather than disappearing into the transport's own buffer.
+//
+// Response latency is measured here too: each response carries the arrival
+// time of its F-code, and the latency is taken when the response's last
+// byte is handed to the transport (after any pacing delay).
+class PacedWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PacedWriter(QObject *parent = nullptr);
+
+    // A response within the data passed to write(): the offset just past
+    // its last byte and the arrival time of the F-code that caused it
+    struct Response {
+        qint64 end;
+        qint64 arrivalNs;
+    };
+
+    void setTransport(Transport *newTransport);
+    void write(const QByteArray &data, bool paced, const QVector<Response> &responses = QVector<Response>());
+    void clear(void);
+
+    // Backpressure counters (safe to read from any thread)
+    qint64 queuedBytes(void) const;
+    qint64 maximumStallMs(void) const;
+    qint64 totalBytesWritten(void) const;
+    qint64 lastResponseLatencyUs(void) const;
+    qint64 maximumResponseLatencyUs(void) const;
+    void resetCounters(void);
+
+    // Interval between paced characters (20 ms on a real VP415)
+    static const qint64 characterIntervalNs = 20000000;
+
+private slots:
+    void writeNext(void);
+    void transportBytesWritten(qint64 bytes);
+
+private:
+    struct Segment {
+        QByteArray data;
+        bool paced;
+    };
+
+    Transport *transport;
+    QQueue<Segment> segments;
+    QTimer *timer;
+    QElapsedTimer clock;
+    qint64 nextCharacterNs;
+
+    // Accounting for data written to the transport but not yet sent
+    qint64 pendingBytes;
+    qint64 bytesInFlight;
+    qint64 stallStartNs;
+    std::atomic<qint64> queueDepth;
+    std::atomic<qint64> maxStallNs;
+    std::atomic<qint64> bytesSent;
+
+    // Responses not yet fully handed to the transport, with their ends as
+    // offsets in the stream of bytes passed to write()
+    QQueue<Response> pendingResponses;
+    qint64 streamQueued;
+    qint64 streamWritten;
+    std::atomic<qint64> lastLatencyNs;
+    std::atomic<qint64> maxLatencyNs;
+
+    void schedule(void);
+    void writeToTransport(const QByteArray &data);
+    void updateDepth(void);
+};
+
+#endif // PACEDWRITER_H
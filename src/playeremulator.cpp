@@ -26,9 +26,121 @@
 ************************************************************************/
 
 #include "playeremulator.h"
+#include "fcodetable.h"
+
+// F-code handlers indexed by opcode
+constexpr PlayerEmulator::FcodeHandler PlayerEmulator::fcodeHandlers[] = {
+    { fcodeOp::invalid,                       nullptr },
+    { fcodeOp::soundInsert,                   &PlayerEmulator::callFcodeXY<&PlayerEmulator::fcodeSoundInsert> },
+    { fcodeOp::rc5Output,                     &PlayerEmulator::callFcodeXY<&PlayerEmulator::fcodeRc5OutputViaEuroconnector> },
+    { fcodeOp::replaySwitchDisable,           &PlayerEmulator::callFcode<&PlayerEmulator::fcodeReplaySwitchDisable> },
+    { fcodeOp::replaySwitchEnable,            &PlayerEmulator::callFcode<&PlayerEmulator::fcodeReplaySwitchEnable> },
+    { fcodeOp::eject,                         &PlayerEmulator::callFcode<&PlayerEmulator::fcodeEject> },
+    { fcodeOp::transmissionDelayOff,          &PlayerEmulator::callFcode<&PlayerEmulator::fcodeTransmissionDelayOff> },
+    { fcodeOp::transmissionDelayOn,           &PlayerEmulator::callFcode<&PlayerEmulator::fcodeTransmissionDelayOn> },
+    { fcodeOp::halt,                          &PlayerEmulator::callFcode<&PlayerEmulator::fcodeHalt> },
+    { fcodeOp::haltAndJumpForward,            &PlayerEmulator::callFcodeXY<&PlayerEmulator::fcodeHaltAndJumpForwards> },
+    { fcodeOp::haltAndJumpReverse,            &PlayerEmulator::callFcodeXY<&PlayerEmulator::fcodeHaltAndJumpReverse> },
+    { fcodeOp::instantJumpForward,            &PlayerEmulator::callFcodeX<&PlayerEmulator::fcodeInstantJumpForward> },
+    { fcodeOp::instantJumpReverse,            &PlayerEmulator::callFcodeX<&PlayerEmulator::fcodeInstantJumpReverse> },
+    { fcodeOp::standby,                       &PlayerEmulator::callFcode<&PlayerEmulator::fcodeStandby> },
+    { fcodeOp::on,                            &PlayerEmulator::callFcode<&PlayerEmulator::fcodeOn> },
+    { fcodeOp::pause,                         &PlayerEmulator::callFcode<&PlayerEmulator::fcodePause> },
+    { fcodeOp::resetToDefault,                &PlayerEmulator::callFcode<&PlayerEmulator::fcodeResetToDefault> },
+    { fcodeOp::pictureNumberRequest,          &PlayerEmulator::callFcode<&PlayerEmulator::fcodePictureNumberRequest> },
+    { fcodeOp::chapterNumberRequest,          &PlayerEmulator::callFcode<&PlayerEmulator::fcodeChapterNumberRequest> },
+    { fcodeOp::discProgramStatusRequest,      &PlayerEmulator::callFcode<&PlayerEmulator::fcodeDiscProgramStatusRequest> },
+    { fcodeOp::playerStatusRequest,           &PlayerEmulator::callFcode<&PlayerEmulator::fcodePlayerStatusRequest> },
+    { fcodeOp::userCodeRequest,               &PlayerEmulator::callFcode<&PlayerEmulator::fcodeUserCodeRequest> },
+    { fcodeOp::revisionLevelRequest,          &PlayerEmulator::callFcode<&PlayerEmulator::fcodeRevisionLevelRequest> },
+    { fcodeOp::audio1Off,                     &PlayerEmulator::callFcode<&PlayerEmulator::fcodeAudio1off> },
+    { fcodeOp::audio1On,                      &PlayerEmulator::callFcode<&PlayerEmulator::fcodeAudio1on> },
+    { fcodeOp::audio2Off,                     &PlayerEmulator::callFcode<&PlayerEmulator::fcodeAudio2off> },
+    { fcodeOp::audio2On,                      &PlayerEmulator::callFcode<&PlayerEmulator::fcodeAudio2on> },
+    { fcodeOp::chapterNumberDisplayOff,       &PlayerEmulator::callFcode<&PlayerEmulator::fcodeChapterNumberDisplayOff> },
+    { fcodeOp::chapterNumberDisplayOn,        &PlayerEmulator::callFcode<&PlayerEmulator::fcodeChapterNumberDisplayOn> },
+    { fcodeOp::pictureNumberDisplayOff,       &PlayerEmulator::callFcode<&PlayerEmulator::fcodePictureNumberTimeCodeDisplayOff> },
+    { fcodeOp::pictureNumberDisplayOn,        &PlayerEmulator::callFcode<&PlayerEmulator::fcodePictureNumberTimeCodeDisplayOn> },
+    { fcodeOp::videoOff,                      &PlayerEmulator::callFcode<&PlayerEmulator::fcodeVideoOff> },
+    { fcodeOp::videoOn,                       &PlayerEmulator::callFcode<&PlayerEmulator::fcodeVideoOn> },
+    { fcodeOp::loadPictureNumberInfoRegister, &PlayerEmulator::callFcodeX<&PlayerEmulator::fcodeLoadPictureNumberInfoRegister> },
+    { fcodeOp::loadPictureNumberStopRegister, &PlayerEmulator::callFcodeX<&PlayerEmulator::fcodeLoadPictureNumberStopRegister> },
+    { fcodeOp::gotoPictureNumberAndHalt,      &PlayerEmulator::callFcodeX<&PlayerEmulator::fcodeGotoPictureNumberAndHalt> },
+    { fcodeOp::gotoPictureNumberAndPlay,      &PlayerEmulator::callFcodeX<&PlayerEmulator::fcodeGotoPictureNumberAndPlay> },
+    { fcodeOp::gotoPictureNumberAndContinue,  &PlayerEmulator::callFcodeX<&PlayerEmulator::fcodeGotoPictureNumberAndContinue> },
+    { fcodeOp::rcToComputerOff,               &PlayerEmulator::callFcode<&PlayerEmulator::fcodeRcToComputerOff> },
+    { fcodeOp::rcToComputerOn,                &PlayerEmulator::callFcode<&PlayerEmulator::fcodeRcToComputerOn> },
+    { fcodeOp::localControlOff,               &PlayerEmulator::callFcode<&PlayerEmulator::fcodeLocalControlOff> },
+    { fcodeOp::localControlOn,                &PlayerEmulator::callFcode<&PlayerEmulator::fcodeLocalControlOn> },
+    { fcodeOp::remoteControlOff,              &PlayerEmulator::callFcode<&PlayerEmulator::fcodeRemoteControlOff> },
+    { fcodeOp::remoteControlOn,               &PlayerEmulator::callFcode<&PlayerEmulator::fcodeRemoteControlOn> },
+    { fcodeOp::stillForward,                  &PlayerEmulator::callFcode<&PlayerEmulator::fcodeStillForward> },
+    { fcodeOp::stillReverse,                  &PlayerEmulator::callFcode<&PlayerEmulator::fcodeStillReverse> },
+    { fcodeOp::playForward,                   &PlayerEmulator::callFcode<&PlayerEmulator::fcodePlayForward> },
+    { fcodeOp::playForwardAndJumpForward,     &PlayerEmulator::callFcodeXY<&PlayerEmulator::fcodePlayForwardAndJumpForward> },
+    { fcodeOp::playForwardAndJumpReverse,     &PlayerEmulator::callFcodeXY<&PlayerEmulator::fcodePlayForwardAndJumpReverse> },
+    { fcodeOp::playReverse,                   &PlayerEmulator::callFcode<&PlayerEmulator::fcodePlayReverse> },
+    { fcodeOp::playReverseAndJumpForward,     &PlayerEmulator::callFcodeXY<&PlayerEmulator::fcodePlayReverseAndJumpForward> },
+    { fcodeOp::playReverseAndJumpReverse,     &PlayerEmulator::callFcodeXY<&PlayerEmulator::fcodePlayReverseAndJumpReverse> },
+    { fcodeOp::gotoChapterAndHalt,            &PlayerEmulator::callFcodeX<&PlayerEmulator::fcodeGotoChapterAndHalt> },
+    { fcodeOp::gotoChapterAndPlay,            &PlayerEmulator::callFcodeX<&PlayerEmulator::fcodeGotoChapterAndPlay> },
+    { fcodeOp::playChapterSequence,           &PlayerEmulator::fcodePlayChapterSequence },
+    { fcodeOp::slowRead,                      &PlayerEmulator::callFcode<&PlayerEmulator::fcodeSlowRead> },
+    { fcodeOp::fastRead,                      &PlayerEmulator::callFcode<&PlayerEmulator::fcodeFastRead> },
+    { fcodeOp::setFastSpeed,                  &PlayerEmulator::callFcodeX<&PlayerEmulator::fcodeSetFastSpeed> },
+    { fcodeOp::setSlowSpeed,                  &PlayerEmulator::callFcodeX<&PlayerEmulator::fcodeSetSlowSpeed> },
+    { fcodeOp::gotoTimeCode,                  &PlayerEmulator::callFcodeXY<&PlayerEmulator::fcodeGotoTimeCode> },
+    { fcodeOp::loadTimeCodeInfoRegister,      &PlayerEmulator::callFcodeXY<&PlayerEmulator::fcodeLoadTimeCodeInfoRegister> },
+    { fcodeOp::slowMotionForward,             &PlayerEmulator::callFcode<&PlayerEmulator::fcodeSlowMotionForward> },
+    { fcodeOp::slowMotionReverse,             &PlayerEmulator::callFcode<&PlayerEmulator::fcodeSlowMotionReverse> },
+    { fcodeOp::videoOverlay,                  &PlayerEmulator::callFcodeParameter<&PlayerEmulator::fcodeVideoOverlay> },
+    { fcodeOp::fastForward,                   &PlayerEmulator::callFcode<&PlayerEmulator::fcodeFastForward> },
+    { fcodeOp::clear,                         &PlayerEmulator::callFcode<&PlayerEmulator::fcodeClear> },
+    { fcodeOp::fastReverse,                   &PlayerEmulator::callFcode<&PlayerEmulator::fcodeFastReverse> },
+    { fcodeOp::audio1FromInternal,            &PlayerEmulator::callFcode<&PlayerEmulator::fcodeAudio1fromInternal> },
+    { fcodeOp::audio1FromExternal,            &PlayerEmulator::callFcode<&PlayerEmulator::fcodeAudio1fromExternal> },
+    { fcodeOp::videoFromInternal,             &PlayerEmulator::callFcode<&PlayerEmulator::fcodeVideoFromInternal> },
+    { fcodeOp::videoFromExternal,             &PlayerEmulator::callFcode<&PlayerEmulator::fcodeVideoFromExternal> },
+    { fcodeOp::audio2FromInternal,            &PlayerEmulator::callFcode<&PlayerEmulator::fcodeAudio2fromInternal> },
+    { fcodeOp::audio2FromExternal,            &PlayerEmulator::callFcode<&PlayerEmulator::fcodeAudio2fromExternal> },
+    { fcodeOp::txtFromDiscOff,                &PlayerEmulator::callFcode<&PlayerEmulator::fcodeTxtFromDiscOff> },
+    { fcodeOp::txtFromDiscOn,                 &PlayerEmulator::callFcode<&PlayerEmulator::fcodeTxtFromDiscOn> }
+};
+
+constexpr size_t PlayerEmulator::fcodeHandlerCount = sizeof(fcodeHandlers) / sizeof(fcodeHandlers[0]);
+
+// Every row from 'index' on is at the position of its opcode
+constexpr bool PlayerEmulator::fcodeHandlersInOrder(size_t index)
+{
+    return index == fcodeHandlerCount ||
+            (static_cast<size_t>(fcodeHandlers[index].opcode) == index && fcodeHandlersInOrder(index + 1));
+}
+
+// Every grammar row from 'row' on has a handler for its opcode
+constexpr bool PlayerEmulator::fcodeGrammarHandled(size_t row)
+{
+    return row == fcodeTableSize ||
+            (static_cast<size_t>(fcodeTable[row].opcode) < fcodeHandlerCount &&
+             fcodeHandlers[static_cast<size_t>(fcodeTable[row].opcode)].handler != nullptr &&
+             fcodeGrammarHandled(row + 1));
+}
+
+// Player with its own frame viewer dialogue
+PlayerEmulator::PlayerEmulator() : PlayerEmulator(nullptr)
+{
+}
+
+// Player driven by the given frame source (or a new frame viewer dialogue
+// if frameSource is null)
+PlayerEmulator::PlayerEmulator(FrameSource *frameSource)
+{
+    // The dispatch table is indexed by opcode, so it must have every opcode
+    // in order, and every command in the grammar needs a handler
+    static_assert(fcodeHandlerCount == static_cast<size_t>(fcodeOp::txtFromDiscOn) + 1,
+                  "The F-code handler table must have one row per opcode");
+    static_assert(fcodeHandlersInOrder(0), "The F-code handler table must be in opcode order");
+    static_assert(fcodeGrammarHandled(0), "Every F-code in the grammar table must have a handler");
 
-PlayerEmulator::PlayerEmulator()
-{
     // Default the frame registers
     frameNumber = 0;
     stopRegister = 0;
@@ -41,6 +153,13 @@ PlayerEmulator::PlayerEmulator()
     frameSpeed = 1; // Number of frames to advance per poll
     direction = playerDirection::forward;
 
+    // Play at normal speed; fast and slow motion default to 3 times and
+    // 1/3 of normal speed
+    playRateFrames = 1;
+    playRateFields = fieldsPerFrame;
+    fastSpeed = 6;
+    slowSpeed = 6;
+
     // Set disc tray to closed
     tray = trayPosition::closed;
 
@@ -57,7 +176,7 @@ PlayerEmulator::PlayerEmulator()
     // Misc settings
     textOutput = switchState::off;
     replay = switchState::on;
-    transmissionDelay = switchState::on;
+    transmissionDelay = switchState::off; // Power-on default (see fcodeTransmissionDelayOff)
     playerStatus = switchState::off; // note on=on and off=standby
     chapterNumberDisplay = switchState::off;
     pictureNumberDisplay = switchState::off;
@@ -71,21 +190,33 @@ PlayerEmulator::PlayerEmulator()
     // Set video overlay mode to LaserVision only
     videoOverlayMode = videoOverlayType::lvOnly;
 
-    // Set the response to F-code waiting flag
-    responseToFcodeWaiting = false;
+    // No F-code has arrived yet
+    fcodeArrivalNs = 0;
 
-    // Reset the delayed F-code counter
-    delayedFcodeCounter = 0;
+    // No clock until one is given
+    clock = nullptr;
+    polledField = 0;
 
-    // Create the frame viewer dialogue
-    frameViewer = new FrameViewerDialog;
+    // Nothing is muted until a search starts; search times are modelled
+    // on the profile in the application settings
+    searchMute = false;
+    seekModel.setProfile(SeekModel::loadProfile());
+
+    // Create the frame viewer dialogue unless another source was given
+    if (frameSource) {
+        frameViewerDialog = nullptr;
+        frameViewer = frameSource;
+    } else {
+        frameViewerDialog = new FrameViewerDialog;
+        frameViewer = frameViewerDialog;
+    }
     frameViewer->pause();
 }
 
 // Show the frame viewer
 void PlayerEmulator::showFrameViewer()
 {
-    frameViewer->show();
+    if (frameViewerDialog) frameViewerDialog->show();
 }
 
 // Load a disc image (video)
@@ -99,76 +230,49 @@ void PlayerEmulator::loadDiscImage(QString fileName)
     qDebug() << "PlayerEmulator::loadDiscImage(): Disc tray set to closed";
 }
 
-// Main time-based polling function for emulation
-void PlayerEmulator::poll(void)
+// Use the given clock for emulated time (otherwise the field passed to
+// poll() is used)
+void PlayerEmulator::setClock(EmulationClock *emulationClock)
 {
-    // Get the current frame number from the media player
-    frameNumber = frameViewer->getFrame();
-
-    // Check for a delayed F-code response
-    if (delayedFcodeCounter > 0)
-    {
-        // Decrement the counter
-        delayedFcodeCounter--;
-
-        // Is it time to send the F-code?
-        if (delayedFcodeCounter == 0) {
-            responseToFcode = delayedFcodeResponse;
-            responseToFcodeWaiting = true;
-
-            if (delayedFcodePlayFlag) frameViewer->play();
-        }
-    }
-
-    // Check STOP register
-    if (stopRegister != 0) {
-        if (direction == playerDirection::forward && frameNumber >= stopRegister) {
-            responseToFcode = stopRegisterResponse;
-            stopRegisterResponse = "";
-            responseToFcodeWaiting = true;
-            frameNumber = stopRegister;
-            stopRegister = 0;
-
-            frameViewer->setFrame(frameNumber);
-            frameViewer->pause();
+    clock = emulationClock;
+}
 
-            qDebug() << "PlayerEmulator::poll(): STOP register event (forward)";
-        }
+// The current emulated PAL field
+qint64 PlayerEmulator::currentField(void) const
+{
+    return clock ? clock->currentField() : polledField;
+}
 
-        if (direction == playerDirection::reverse && frameNumber <= stopRegister) {
-            responseToFcode = stopRegisterResponse;
-            stopRegisterResponse = "";
-            responseToFcodeWaiting = true;
-            frameNumber = stopRegister;
-            stopRegister = 0;
+// Main time-based polling function for emulation (called at least once per
+// field with the current field number)
+void PlayerEmulator::poll(qint64 field)
+{
+    polledField = field;
 
-            frameViewer->setFrame(frameNumber);
-            frameViewer->pause();
+    // Get the current frame number from the media player
+    frameNumber = frameViewer->getFrame();
 
-            qDebug() << "PlayerEmulator::poll(): STOP register event (reverse)";
-        }
+    // Run the timed events that are due (their responses join the
+    // response queue behind any that have not been sent yet)
+    while (const EventScheduler::Event *event = events.front(field)) {
+        // Events can schedule other events, so remove this one first
+        EventScheduler::Event dueEvent = *event;
+        events.pop();
+        runEvent(dueEvent);
     }
+}
 
-    // Check INFO register
-    if (infoRegister != 0) {
-        if (direction == playerDirection::forward && frameNumber >= infoRegister) {
-            responseToFcode = infoRegisterResponse;
-            infoRegisterResponse = "";
-            responseToFcodeWaiting = true;
-            infoRegister = 0;
-
-            qDebug() << "PlayerEmulator::poll(): INFO register event (forward)";
-        }
-
-        if (direction == playerDirection::reverse && frameNumber <= infoRegister) {
-            responseToFcode = infoRegisterResponse;
-            infoRegisterResponse = "";
-            responseToFcodeWaiting = true;
-            infoRegister = 0;
+// Field of the next scheduled event (-1 if there is none)
+qint64 PlayerEmulator::nextEventField(void) const
+{
+    return events.nextField();
+}
 
-            qDebug() << "PlayerEmulator::poll(): INFO register event (reverse)";
-        }
-    }
+// The player is idle when it is halted with no response waiting; only a
+// scheduled event or a new command can then change its state
+bool PlayerEmulator::isIdle(void)
+{
+    return responses.isEmpty() && !frameViewer->isPlaying();
 }
 
 // Receive user code
@@ -181,532 +285,208 @@ void PlayerEmulator::receiveUserCode(QByteArray userCodeBuffer)
 }
 
 // Receive F-Code
-void PlayerEmulator::receiveFcode(QByteArray fcodeBuffer)
+void PlayerEmulator::receiveFcode(const QByteArray &fcodeBuffer, qint64 arrivalNs)
 {
-    int x, y;
-
-    // Output the received F-Code buffer to the debug
-    qDebug() << "receiveFcode(): Got F-Code string = " << QString(fcodeBuffer);
-
-    // Decode the F-Code buffer and call the correct F-Code handler function
-    switch(fcodeBuffer[0])
-    {
-        // Sound insert (beep)
-        case 0x21: // !xy
-        // Check that the f-code is the right length
-        if (fcodeBuffer.length() != 3) fcodeSoundInsert(0, 0);
-        else
-        {
-            // Extract parameters and call handler
-            x = (int)(fcodeBuffer[1] - '0');
-            y = (int)(fcodeBuffer[2] - '0');
-            if (x > 9) x = 0;
-            if (y > 9) y = 0;
-
-            fcodeSoundInsert(x, y);
-        }
-        break;
-
-        // RC-5 command out via A/V EUROCONNECTOR
-        case 0x23: // #xy
-        qDebug() << "Parameter decode not implemented for this F-Code!";
-        break;
+    FcodeCommand command;
 
-        // Replay switch
-        case 0x24: // $0, $1
-        switch(fcodeBuffer[1])
-        {
-            case '0':
-            fcodeReplaySwitchDisable();
-            break;
-
-            case '1':
-            fcodeReplaySwitchEnable();
-            break;
-
-            default:
-            qDebug() << "Invalid parameters for F-Code!";
-            break;
-        }
-        break;
+    // Remember when the F-code arrived so that its response can be timed
+    fcodeArrivalNs = arrivalNs;
 
-        // Eject
-        case 0x27: // '
-        fcodeEject();
-        break;
+    // Decode the F-Code buffer; only failures are logged so that a busy
+    // link does not spend its time formatting debug output
+    if (!FcodeDecoder::decode(fcodeBuffer.constData(), static_cast<size_t>(fcodeBuffer.size()), command)) {
+        qDebug() << "receiveFcode():" << FcodeDecoder::errorName(command.error)
+                 << "for F-Code" << FcodeDecoder::opcodeName(command.opcode) << fcodeBuffer;
 
-        // Transmission delay
-        case 0x29: // )0, )1
-        switch(fcodeBuffer[1])
-        {
-            case '0':
-            fcodeTransmissionDelayOff();
-            break;
-
-            case '1':
-            fcodeTransmissionDelayOn();
-            break;
-
-            default:
-            qDebug() << "Invalid parameters for F-Code!";
-            break;
+        // Commands with an acknowledge are rejected with their negative
+        // acknowledge (the others are ignored, as on a real player)
+        if (command.negativeAck) {
+            postResponse(command.negativeAck);
         }
-        break;
-
-        // Halt
-        case 0x2A: // *
-        if (fcodeBuffer.length() == 1) {
-            fcodeHalt();
+    } else {
+        // Call the F-Code handler function for the opcode
+        size_t index = static_cast<size_t>(command.opcode);
+        if (index < fcodeHandlerCount && fcodeHandlers[index].handler) {
+            (this->*fcodeHandlers[index].handler)(command);
         } else {
-            qDebug() << "Parameter decode not implemented for this F-Code!";
+            qDebug() << "receiveFcode(): No handler for F-Code" << FcodeDecoder::opcodeName(command.opcode);
         }
-        break;
 
-        // Instant jump forward
-        case 0x2B: // +
-        qDebug() << "Parameter decode not implemented for this F-Code!";
-        break;
-
-        // Standby/On
-        case 0x2C: // ,
-        switch(fcodeBuffer[1])
-        {
-            case '0':
-            fcodeStandby();
-            break;
-
-            case '1':
-            fcodeOn();
-            break;
-
-            default:
-            qDebug() << "Invalid parameters for F-Code!";
-            break;
-        }
-        break;
-
-        // Instant jump reverse
-        case 0x2D: // -
-        qDebug() << "Parameter decode not implemented for this F-Code!";
-        break;
-
-        // Pause
-        case 0x2F: // /
-        fcodePause();
-        break;
-
-        // Reset to default
-        case 0x3A: // :
-        fcodeResetToDefault();
-        break;
+        // The command may have moved the disc or changed a register
+        scheduleRegisterEvents();
+    }
+}
 
-        // Request
-        case 0x3F: // ?
-        switch(fcodeBuffer[1])
-        {
-            case 'F':
-            fcodePictureNumberRequest();
-            break;
-
-            case 'C':
-            fcodeChapterNumberRequest();
-            break;
-
-            case 'D':
-            fcodeDiscProgramStatusRequest();
-            break;
-
-            case 'P':
-            fcodePlayerStatusRequest();
-            break;
-
-            case 'U':
-            fcodeUserCodeRequest();
-            break;
-
-            case '=':
-            fcodeRevisionLevelRequest();
-            break;
-
-            default:
-            qDebug() << "Invalid parameters for F-Code!";
-            break;
-        }
-        break;
+// Take the next F-code response from the queue (arrivalNs is set to the
+// arrival time of the F-code that caused it).  Returns an empty response
+// once the queue is empty.
+QByteArray PlayerEmulator::sendFcodeResponse(qint64 &arrivalNs)
+{
+    arrivalNs = 0;
+    if (responses.isEmpty()) return QByteArray();
 
-        // Audio-1 on/off
-        case 0x41: // A0, A1
-        switch(fcodeBuffer[1])
-        {
-            case '0':
-            fcodeAudio1off();
-            break;
-
-            case '1':
-            fcodeAudio1on();
-            break;
-
-            default:
-            qDebug() << "Invalid parameters for F-Code!";
-            break;
-        }
-        break;
+    Response response = responses.dequeue();
+    arrivalNs = response.arrivalNs;
+    return response.text;
+}
 
-        // Audio-2 on/off
-        case 0x42: // B0, B1
-        switch(fcodeBuffer[1])
-        {
-            case '0':
-            fcodeAudio2off();
-            break;
-
-            case '1':
-            fcodeAudio2on();
-            break;
-
-            default:
-            qDebug() << "Invalid parameters for F-Code!";
-            break;
-        }
-        break;
+// Queue a response to the F-code being handled
+void PlayerEmulator::postResponse(const QByteArray &response)
+{
+    postResponse(response, fcodeArrivalNs);
+}
 
-        // Chapter number display on/off
-        case 0x43: // C0, C1
-        switch(fcodeBuffer[1])
-        {
-            case '0':
-            fcodeChapterNumberDisplayOff();
-            break;
-
-            case '1':
-            fcodeChapterNumberDisplayOn();
-            break;
-
-            default:
-            qDebug() << "Invalid parameters for F-Code!";
-            break;
-        }
-        break;
+// Queue a response.  Every response, immediate or timed, goes through the
+// one queue so that none can overwrite another before it has been sent.
+void PlayerEmulator::postResponse(const QByteArray &response, qint64 arrivalNs)
+{
+    if (response.isEmpty()) return;
 
-        // Picture number/time code display on/off
-        case 0x44: // D0, D1
-        switch(fcodeBuffer[1])
-        {
-            case '0':
-            fcodePictureNumberTimeCodeDisplayOff();
-            break;
-
-            case '1':
-            fcodePictureNumberTimeCodeDisplayOn();
-            break;
-
-            default:
-            qDebug() << "Invalid parameters for F-Code!";
-            break;
-        }
-        break;
+    Response queued;
+    queued.text = response;
+    queued.arrivalNs = arrivalNs;
+    responses.enqueue(queued);
+}
 
-        // Video on/off
-        case 0x45: // E
-        switch(fcodeBuffer[1])
-        {
-            case '0':
-            fcodeVideoOff();
-            break;
-
-            case '1':
-            fcodeVideoOn();
-            break;
-
-            default:
-            qDebug() << "Invalid parameters for F-Code!";
-            break;
-        }
-        break;
+// Sends an F-code response after a specified number of fields
+void PlayerEmulator::sendDelayedFcodeResponse(const char *fcodeResponse, int fieldDelay)
+{
+    events.scheduleResponse(currentField() + fieldDelay, fcodeResponse, fcodeArrivalNs);
+}
 
-        // Load/Goto picture number
-        case 0x46: // F
-        // F-Code must be at least 3 characters long and no more than 7 characters
-        if (fcodeBuffer.length() < 3 || fcodeBuffer.length() > 7)
-        {
-            qDebug() << "Invalid parameter length for F-Code!";
-        }
-        else
-        {
-            QString fcodeBufferString = QString(fcodeBuffer);
-            QString parameterString;
-            parameterString = fcodeBufferString.mid(1, fcodeBufferString.length() - 2);
-
-            x = parameterString.toInt();
-
-            // Now pick the correct command handler and send the parameter
-            switch(fcodeBuffer[fcodeBuffer.length()-1])
-            {
-                case 'I':
-                fcodeLoadPictureNumberInfoRegister(x);
-                break;
-
-                case 'S':
-                fcodeLoadPictureNumberStopRegister(x);
-                break;
-
-                case 'R':
-                fcodeGotoPictureNumberAndHalt(x);
-                break;
-
-                case 'N':
-                fcodeGotoPictureNumberAndPlay(x);
-                break;
-
-                case 'Q':
-                fcodeGotoPictureNumberAndContinue(x);
-                break;
-
-                default:
-                qDebug() << "Invalid parameters for F-Code!";
-                break;
-            }
-        }
-        break;
+// Runs a player action after a specified number of fields (actions
+// scheduled for the same field run in the order they were scheduled)
+void PlayerEmulator::scheduleEvent(EventScheduler::eventType type, int fieldDelay)
+{
+    events.schedule(currentField() + fieldDelay, type);
+}
 
-        // Remote control routing
-        case 0x48: // H
-        switch(fcodeBuffer[1])
-        {
-            case '0':
-            fcodeRcToComputerOff();
-            break;
-
-            case '1':
-            fcodeRcToComputerOn();
-            break;
-
-            default:
-            qDebug() << "Invalid parameters for F-Code!";
-            break;
-        }
-        break;
+// Search for a picture and then halt or play, giving the acknowledge when
+// the picture is found.  The search time comes from the seek model: within
+// the instant jump region the search is immediate and nothing is muted;
+// otherwise audio and video are shown as muted until the pickup has
+// settled.
+void PlayerEmulator::searchPicture(qint64 picture, const char *response, bool playAfterSearch)
+{
+    SeekModel::discType type = (currentDiscType == discType::CLV) ? SeekModel::discType::CLV : SeekModel::discType::CAV;
+    qint64 fieldDelay = seekModel.seekFields(frameViewer->getFrame(), picture, type);
 
-        // Local front panel buttons
-        case 0x49: // I
-        switch(fcodeBuffer[1])
-        {
-            case '0':
-            fcodeLocalControlOff();
-            break;
-
-            case '1':
-            fcodeLocalControlOn();
-            break;
-
-            default:
-            qDebug() << "Invalid parameters for F-Code!";
-            break;
-        }
-        break;
+    frameViewer->setFrame(picture);
 
-        // Remote control enable/disable
-        case 0x4A: // J
-        switch(fcodeBuffer[1])
-        {
-            case '0':
-            fcodeRemoteControlOff();
-            break;
-
-            case '1':
-            fcodeRemoteControlOn();
-            break;
-
-            default:
-            qDebug() << "Invalid parameters for F-Code!";
-            break;
-        }
-        break;
+    if (fieldDelay == 0) {
+        // Respond immediately
+        postResponse(response);
 
-        // Still forward
-        case 0x4C: // L
-        fcodeStillForward();
-        break;
+        if (playAfterSearch) frameViewer->play();
+        else frameViewer->pause();
+        return;
+    }
 
-        // Still reverse
-        case 0x4D: // M
-        fcodeStillReverse();
-        break;
+    frameViewer->pause();
+    searchMute = true;
+    sendDelayedFcodeResponse(response, static_cast<int>(fieldDelay));
+    if (playAfterSearch) scheduleEvent(EventScheduler::eventType::play, static_cast<int>(fieldDelay));
+    scheduleEvent(EventScheduler::eventType::unmute, static_cast<int>(fieldDelay));
+}
 
-        // Play forward
-        case 0x4E: // N
-        if (fcodeBuffer.length() == 1) {
-            fcodePlayForward();
-        } else {
-            qDebug() << "Parameter decode not implemented for this F-Code!";
-        }
+// Carry out a timed event once its field is reached
+void PlayerEmulator::runEvent(const EventScheduler::Event &event)
+{
+    switch (event.type) {
+        case EventScheduler::eventType::response:
+        postResponse(QByteArray(event.response, static_cast<int>(event.responseLength)), event.arrivalNs);
         break;
 
-        // Play reverse
-        case 0x4F: // O
-        if (fcodeBuffer.length() == 1) {
-            fcodePlayReverse();
-        } else {
-            qDebug() << "Parameter decode not implemented for this F-Code!";
-        }
+        case EventScheduler::eventType::play:
+        frameViewer->play();
+        scheduleRegisterEvents();
         break;
 
-        // Goto chapter and halt/play
-        case 0x51: // Q
-        qDebug() << "Parameter decode not implemented for this F-Code!";
+        case EventScheduler::eventType::unmute:
+        searchMute = false;
         break;
 
-        // Set read speed
-        case 0x52: // R
-        switch(fcodeBuffer[1])
-        {
-            case '0':
-            fcodeSlowRead();
-            break;
-
-            case '1':
-            fcodeFastRead();
-            break;
-
-            default:
-            qDebug() << "Invalid parameters for F-Code!";
-            break;
-        }
-        break;
+        case EventScheduler::eventType::stopRegisterReached:
+        if (stopRegister == 0) break;
+        qDebug() << "PlayerEmulator::runEvent(): STOP register event at picture" << stopRegister;
 
-        // Set fast/slow speed value
-        case 0x53: // S
-        qDebug() << "Parameter decode not implemented for this F-Code!";
-        break;
+        postResponse(stopRegisterResponse, 0);
+        stopRegisterResponse = "";
 
-        // Goto/Load time code register
-        case 0x54: // T
-        qDebug() << "Parameter decode not implemented for this F-Code!";
+        // Halt exactly on the STOP picture
+        frameNumber = stopRegister;
+        stopRegister = 0;
+        frameViewer->setFrame(frameNumber);
+        frameViewer->pause();
+        frameViewer->setStopFrame(0);
         break;
 
-        // Slow motion forward
-        case 0x55: // U
-        fcodeSlowMotionForward();
-        break;
+        case EventScheduler::eventType::infoRegisterReached:
+        if (infoRegister == 0) break;
+        qDebug() << "PlayerEmulator::runEvent(): INFO register event at picture" << infoRegister;
 
-        // Slow motion reverse (V) or Video Overlay (VP)
-        case 0x56: // V, VP
-        if (fcodeBuffer.length() == 1) fcodeSlowMotionReverse();
-        else fcodeVideoOverlay(fcodeBuffer[2]);
+        postResponse(infoRegisterResponse, 0);
+        infoRegisterResponse = "";
+        infoRegister = 0;
         break;
+    }
+}
 
-        // Fast forward
-        case 0x57: // W
-        fcodeFastForward();
-        break;
+// Work out the fields in which play will reach the STOP and INFO registers
+// and schedule their events there, rather than noticing the crossing after
+// the picture has been shown.  Play moves one picture every two fields; a
+// register that has already been reached fires in the current field.
+// Called whenever the position, play mode or registers may have changed.
+void PlayerEmulator::scheduleRegisterEvents(void)
+{
+    events.cancel(EventScheduler::eventType::stopRegisterReached);
+    events.cancel(EventScheduler::eventType::infoRegisterReached);
 
-        // Clear
-        case 0x58: // X
-        fcodeClear();
-        break;
+    // The frame source holds forward play on the STOP picture in case the
+    // event is late
+    frameViewer->setStopFrame(direction == playerDirection::forward ? stopRegister : 0);
 
-        // Fast reverse
-        case 0x5A: // Z
-        fcodeFastReverse();
-        break;
+    qint64 field = currentField();
+    qint64 frame = frameViewer->getFrame();
+    bool playing = frameViewer->isPlaying();
 
-        // Audio-1 routing
-        case 0x5B: // [0, [1
-        switch(fcodeBuffer[1])
-        {
-            case '0':
-            fcodeAudio1fromInternal();
-            break;
-
-            case '1':
-            fcodeAudio1fromExternal();
-            break;
-
-            default:
-            qDebug() << "Invalid parameters for F-Code!";
-            break;
-        }
-        break;
+    qint64 crossingField = registerCrossingField(stopRegister, frame, field, playing);
+    if (crossingField >= 0) events.schedule(crossingField, EventScheduler::eventType::stopRegisterReached);
 
-        // Video routing
-        case 0x5C: // '\'
-        switch(fcodeBuffer[1])
-        {
-            case '0':
-            fcodeVideoFromInternal();
-            break;
-
-            case '1':
-            fcodeVideoFromExternal();
-            break;
-
-            default:
-            qDebug() << "Invalid parameters for F-Code!";
-            break;
-        }
-        break;
+    crossingField = registerCrossingField(infoRegister, frame, field, playing);
+    if (crossingField >= 0) events.schedule(crossingField, EventScheduler::eventType::infoRegisterReached);
+}
 
-        // Audio-2 routing
-        case 0x5D: // ]0, ]1
-        switch(fcodeBuffer[1])
-        {
-            case '0':
-            fcodeAudio2fromInternal();
-            break;
-
-            case '1':
-            fcodeAudio2fromExternal();
-            break;
-
-            default:
-            qDebug() << "Invalid parameters for F-Code!";
-            break;
-        }
-        break;
+// Field in which play reaches a register (-1 if it never will)
+qint64 PlayerEmulator::registerCrossingField(qint64 registerFrame, qint64 frame, qint64 field, bool playing) const
+{
+    if (registerFrame == 0) return -1;
 
-        // Teletext on/off
-        case 0x5F: // _0, _1
-        switch(fcodeBuffer[1])
-        {
-            case '0':
-            fcodeTxtFromDiscOff();
-            break;
-
-            case '1':
-            fcodeTxtFromDiscOn();
-            break;
-
-            default:
-            qDebug() << "Invalid parameters for F-Code!";
-            break;
-        }
-        break;
+    qint64 framesToGo = (direction == playerDirection::forward) ? registerFrame - frame : frame - registerFrame;
+    if (framesToGo <= 0) return field;
+    if (!playing) return -1;
 
-        default:
-        qDebug() << "Unknown F-Code received!";
-        break;
-    }
+    // Count from the field the current picture started in, at the current
+    // play rate (rounding up to the field the register picture is shown)
+    qint64 frameStartField = field - frameViewer->fieldsIntoFrame();
+    qint64 crossingField = frameStartField + (framesToGo * playRateFields + playRateFrames - 1) / playRateFrames;
+    return crossingField > field ? crossingField : field;
 }
 
-// Send F-code response and clear
-QByteArray PlayerEmulator::sendFcodeResponse()
+// Change the play rate, moving the register events to match
+void PlayerEmulator::setPlayRate(qint64 frames, qint64 fields)
 {
-    QByteArray response;
-    if (responseToFcodeWaiting) {
-        response = responseToFcode;
-        responseToFcode.clear();
-        responseToFcodeWaiting = false;
-    }
+    if (frames == playRateFrames && fields == playRateFields) return;
 
-    return response;
+    playRateFrames = frames;
+    playRateFields = fields;
+    scheduleRegisterEvents();
 }
 
-// Sends an F-code after a specified number of poll loops
-void PlayerEmulator::sendDelayedFcodeResponse(QByteArray fcodeResponse, int pollDelay, bool playAfterSend)
+// Should responses be sent at 50 char/s?
+bool PlayerEmulator::isTransmissionDelayOn(void)
 {
-    delayedFcodeResponse = fcodeResponse;
-    delayedFcodeCounter = pollDelay;
-    delayedFcodePlayFlag = playAfterSend;
+    return transmissionDelay == switchState::on;
 }
 
 // ----------------------------------------------------------------------------------------------------------------------
@@ -759,6 +539,9 @@ QString PlayerEmulator::getAudio1(void)
 {
     QString currentState;
 
+    // Audio is muted while a search is in progress
+    if (searchMute) return "Muted";
+
     switch(audio1) {
         case flagState::enabled:
         currentState = "On";
@@ -776,6 +559,9 @@ QString PlayerEmulator::getAudio2(void)
 {
     QString currentState;
 
+    // Audio is muted while a search is in progress
+    if (searchMute) return "Muted";
+
     switch(audio2) {
         case flagState::enabled:
         currentState = "On";
@@ -810,6 +596,9 @@ QString PlayerEmulator::getVideoOutput(void)
 {
     QString currentState;
 
+    // Video is muted while a search is in progress
+    if (searchMute) return "Muted";
+
     switch(videoOutput) {
         case flagState::enabled:
         currentState = "On";
@@ -935,7 +724,7 @@ void PlayerEmulator::fcodeEject(void)
     // This response is sent after the tray is opened and, if we send it too
     // quickly, the Domesday software will miss it.
     qDebug() << "fcodeEject(): Sending delayed O response";
-    sendDelayedFcodeResponse("O", 50, false); // Don't play after send
+    sendDelayedFcodeResponse("O", 100); // 2 seconds
 }
 
 // TRANSMISSION DELAY OFF
@@ -1118,8 +907,7 @@ void PlayerEmulator::fcodeOn(void)
 
    if (tray == trayPosition::open) {
         // Respond that tray is already open
-        responseToFcode = "O";
-        responseToFcodeWaiting = true;
+        postResponse("O");
         return;
     }
 
@@ -1129,8 +917,7 @@ void PlayerEmulator::fcodeOn(void)
     frameViewer->pause();
 
     // Respond that drive is spun-up and ready
-    responseToFcode = "S";
-    responseToFcodeWaiting = true;
+    postResponse("S");
 }
 
 // PAUSE
@@ -1181,8 +968,7 @@ void PlayerEmulator::fcodePictureNumberRequest(void)
 
    if (tray == trayPosition::open) {
         // Respond that tray is already open
-        responseToFcode = "O";
-        responseToFcodeWaiting = true;
+        postResponse("O");
         return;
     }
 
@@ -1191,12 +977,10 @@ void PlayerEmulator::fcodePictureNumberRequest(void)
         QString currentFrame = QString("%1").arg(frameNumber, 5, 10, QChar('0'));
         qDebug() << "fcodePictureNumberRequest(): Current frame number is " << frameNumber;
 
-        responseToFcode = "F" + currentFrame.toLocal8Bit();
-        responseToFcodeWaiting = true;
+        postResponse("F" + currentFrame.toLocal8Bit());
    } else {
        // Wrong disc type
-       responseToFcode = "X";
-       responseToFcodeWaiting = true;
+       postResponse("X");
    }
 }
 
@@ -1414,14 +1198,12 @@ void PlayerEmulator::fcodeUserCodeRequest(void)
 
    if (tray == trayPosition::open) {
         // Respond that tray is already open
-        responseToFcode = "O";
-        responseToFcodeWaiting = true;
+        postResponse("O");
         return;
     }
 
    // Send the response
-    responseToFcode = "U" + currentUserCode;
-    responseToFcodeWaiting = true;
+    postResponse("U" + currentUserCode);
 }
 
 // REVISION LEVEL REQUEST
@@ -1612,8 +1394,7 @@ void PlayerEmulator::fcodeLoadPictureNumberInfoRegister(int x)
 
     if (tray == trayPosition::open) {
         // Respond that tray is already open
-        responseToFcode = "O";
-        responseToFcodeWaiting = true;
+        postResponse("O");
         return;
     }
 
@@ -1622,8 +1403,7 @@ void PlayerEmulator::fcodeLoadPictureNumberInfoRegister(int x)
         infoRegisterResponse = "A3";
    } else {
        // Wrong disc type
-       responseToFcode = "AN";
-       responseToFcodeWaiting = true;
+       postResponse("AN");
    }
 }
 
@@ -1647,8 +1427,7 @@ void PlayerEmulator::fcodeLoadPictureNumberStopRegister(int x)
 
    if (tray == trayPosition::open) {
         // Respond that tray is already open
-        responseToFcode = "O";
-        responseToFcodeWaiting = true;
+        postResponse("O");
         return;
     }
 
@@ -1657,8 +1436,7 @@ void PlayerEmulator::fcodeLoadPictureNumberStopRegister(int x)
         stopRegisterResponse = "A2";
    } else {
        // Wrong disc type
-       responseToFcode = "AN";
-       responseToFcodeWaiting = true;
+       postResponse("AN");
    }
 }
 
@@ -1687,30 +1465,18 @@ void PlayerEmulator::fcodeGotoPictureNumberAndHalt(int x)
 
    if (tray == trayPosition::open) {
         // Respond that tray is already open
-        responseToFcode = "O";
-        responseToFcodeWaiting = true;
+        postResponse("O");
         return;
     }
 
    if (currentDiscType == discType::CAV) {
-        frameViewer->setFrame(x);
-        frameViewer->pause();
-
-        if (std::abs(frameNumber - x) > 50) {
-            // Send delayed F-code to emulate head movement delay
-            sendDelayedFcodeResponse("A0", 15, false); // Don't play after send
-        } else {
-            // Respond immediately
-            responseToFcode = "A0";
-            responseToFcodeWaiting = true;
-        }
+        searchPicture(x, "A0", false);
 
         // Clear STOP register
         stopRegister = 0;
    } else {
        // Wrong disc type
-       responseToFcode = "AN";
-       responseToFcodeWaiting = true;
+       postResponse("AN");
    }
 }
 
@@ -1739,30 +1505,18 @@ void PlayerEmulator::fcodeGotoPictureNumberAndPlay(int x)
 
    if (tray == trayPosition::open) {
         // Respond that tray is already open
-        responseToFcode = "O";
-        responseToFcodeWaiting = true;
+        postResponse("O");
         return;
     }
 
    if (currentDiscType == discType::CAV) {
-        frameViewer->setFrame(x);
-
-        if (std::abs(frameNumber - x) > 50) {
-            // Send delayed F-code to emulate head movement delay
-            sendDelayedFcodeResponse("A1", 15, true); // Play after send
-        } else {
-            // Respond immediately
-            responseToFcode = "A1";
-            responseToFcodeWaiting = true;
-            frameViewer->play();
-        }
+        searchPicture(x, "A1", true);
 
         // Clear STOP register
         stopRegister = 0;
    } else {
        // Wrong disc type
-       responseToFcode = "AN";
-       responseToFcodeWaiting = true;
+       postResponse("AN");
    }
 }
 
@@ -1791,30 +1545,18 @@ void PlayerEmulator::fcodeGotoPictureNumberAndContinue(int x)
 
    if (tray == trayPosition::open) {
         // Respond that tray is already open
-        responseToFcode = "O";
-        responseToFcodeWaiting = true;
+        postResponse("O");
         return;
     }
 
    if (currentDiscType == discType::CAV) {
-        if (frameViewer->isPlaying()) {
-            frameViewer->setFrame(x);
-            frameViewer->play();
-            responseToFcode = "A0";
-            responseToFcodeWaiting = true;
-        } else {
-            frameViewer->setFrame(x);
-            frameViewer->pause();
-            responseToFcode = "A0";
-            responseToFcodeWaiting = true;
-        }
+        searchPicture(x, "A0", frameViewer->isPlaying());
 
         // Clear STOP register
         stopRegister = 0;
    } else {
        // Wrong disc type
-       responseToFcode = "AN";
-       responseToFcodeWaiting = true;
+       postResponse("AN");
    }
 }
 
@@ -1953,6 +1695,7 @@ void PlayerEmulator::fcodePlayForward(void)
    qDebug() << "fcodePlayForward(): Called";
 
    direction = playerDirection::forward;
+   setPlayRate(1, fieldsPerFrame);
    frameViewer->play();
 }
 
@@ -2012,6 +1755,7 @@ void PlayerEmulator::fcodePlayReverse(void)
 {
    qDebug() << "fcodePlayReverse(): Called";
    direction = playerDirection::reverse;
+   setPlayRate(1, fieldsPerFrame);
    frameViewer->play();
 }
 
@@ -2126,9 +1870,11 @@ void PlayerEmulator::fcodeGotoChapterAndPlay(int x)
 // sequence is terminated.
 //
 // During a Goto, the video and audio are muted.
-void PlayerEmulator::fcodePlayChapterSequence(QByteArray sequence)
+void PlayerEmulator::fcodePlayChapterSequence(const FcodeCommand &command)
 {
-   qDebug() << "fcodePlayChapterSequence(): Called with sequence = " << sequence;
+   QString sequence;
+   for (size_t chapter = 0; chapter < command.sequenceLength; chapter++) sequence += QString(" %1").arg(command.sequence[chapter]);
+   qDebug() << "fcodePlayChapterSequence(): Called with sequence =" << sequence;
    qDebug() << "Function not implemented!";
 }
 
@@ -2153,7 +1899,15 @@ void PlayerEmulator::fcodePlayChapterSequence(QByteArray sequence)
 void PlayerEmulator::fcodeSetFastSpeed(int x)
 {
     qDebug() << "fcodeSetFastSpeed(): Called with x = " << x;
-    qDebug() << "Function not implemented!";
+
+    if (x < 2 || x > 40) {
+        qDebug() << "fcodeSetFastSpeed(): Speed out of range - ignored";
+        return;
+    }
+    fastSpeed = x;
+
+    // Fast motion moves x/2 pictures every two fields (fast motion play
+    // itself is not implemented yet, so normal play is unaffected)
 }
 
 // SET SLOW SPEED (CAV only)
@@ -2178,7 +1932,15 @@ void PlayerEmulator::fcodeSetFastSpeed(int x)
 void PlayerEmulator::fcodeSetSlowSpeed(int x)
 {
     qDebug() << "fcodeSetSlowSpeed(): Called with x = " << x;
-    qDebug() << "Function not implemented!";
+
+    if (x < 2 || x > 250) {
+        qDebug() << "fcodeSetSlowSpeed(): Speed out of range - ignored";
+        return;
+    }
+    slowSpeed = x;
+
+    // Slow motion moves one picture every x fields (slow motion play itself
+    // is not implemented yet, so normal play is unaffected)
 }
 
 // GOTO TIME CODE (CLV only)
@@ -2204,7 +1966,20 @@ void PlayerEmulator::fcodeSetSlowSpeed(int x)
 void PlayerEmulator::fcodeGotoTimeCode(int x, int y)
 {
     qDebug() << "fcodeGotoTimeCode(): Called with x = " << x << " and y = " << y;
-    qDebug() << "Function not implemented!";
+
+    if (tray == trayPosition::open) {
+        // Respond that tray is already open
+        postResponse("O");
+        return;
+    }
+
+    if (currentDiscType == discType::CLV) {
+        // CLV discs run at 25 pictures per second from the first picture
+        searchPicture((x * 60 + y) * 25 + 1, "A8", true);
+    } else {
+        // Wrong disc type
+        postResponse("AN");
+    }
 }
 
 // LOAD TIME CODE INFO REGISTER (CLV only)
@@ -2311,6 +2086,10 @@ void PlayerEmulator::fcodeClear(void)
     stopRegister = 0;
     stopRegisterResponse = "";
 
+    // Cancel any delayed responses and pending actions
+    events.clear();
+    searchMute = false;
+
     frameViewer->pause();
 }
 
@@ -2346,7 +2125,7 @@ void PlayerEmulator::fcodeClear(void)
 // VPX = 	This command interrogates the system for its
 // 			current video mode. The reply code is identical to
 // 			the appropriate video command i.e. VP1 to VP5.
-void PlayerEmulator::fcodeVideoOverlay(QByteRef parameter)
+void PlayerEmulator::fcodeVideoOverlay(char parameter)
 {
    qDebug() << "fcodeVideoOverlay(): Called with parameter = " << parameter;
 
@@ -2374,15 +2153,14 @@ void PlayerEmulator::fcodeVideoOverlay(QByteRef parameter)
 
        case 'X':
        if (tray == trayPosition::open) {
-           responseToFcode = "O";
+           postResponse("O");
        } else {
-        if (videoOverlayMode == videoOverlayType::lvOnly) responseToFcode = "VP1";
-        if (videoOverlayMode == videoOverlayType::external) responseToFcode = "VP2";
-        if (videoOverlayMode == videoOverlayType::hardKeyed) responseToFcode = "VP3";
-        if (videoOverlayMode == videoOverlayType::mixed) responseToFcode = "VP4";
-        if (videoOverlayMode == videoOverlayType::enhanced) responseToFcode = "VP5";
+        if (videoOverlayMode == videoOverlayType::lvOnly) postResponse("VP1");
+        if (videoOverlayMode == videoOverlayType::external) postResponse("VP2");
+        if (videoOverlayMode == videoOverlayType::hardKeyed) postResponse("VP3");
+        if (videoOverlayMode == videoOverlayType::mixed) postResponse("VP4");
+        if (videoOverlayMode == videoOverlayType::enhanced) postResponse("VP5");
        }
-       responseToFcodeWaiting = true;
        break;
 
        default:
@@ -29,9 +29,15 @@
 #define PLAYEREMULATOR_H
 
 #include <QString>
+#include <QQueue>
 #include <QDebug>
 
 #include "frameviewerdialog.h"
+#include "framesource.h"
+#include "fcodedecoder.h"
+#include "emulationclock.h"
+#include "eventscheduler.h"
+#include "seekmodel.h"
 
 class FrameViewerDialog;
 
@@ -39,16 +45,23 @@ class PlayerEmulator
 {
 public:
     PlayerEmulator();
+    explicit PlayerEmulator(FrameSource *frameSource);
 
     void showFrameViewer();
     void loadDiscImage(QString fileName);
 
-    void poll(void);
+    void setClock(EmulationClock *emulationClock);
+    qint64 currentField(void) const;
+    void poll(qint64 field);
+    qint64 nextEventField(void) const;
+    bool isIdle(void);
 
     void receiveUserCode(QByteArray userCodeBuffer);
-    void receiveFcode(QByteArray fcodeBuffer);
-    QByteArray sendFcodeResponse();
-    void sendDelayedFcodeResponse(QByteArray fcodeResponse, int pollDelay, bool playAfterSend);
+    void receiveFcode(const QByteArray &fcodeBuffer, qint64 arrivalNs);
+    QByteArray sendFcodeResponse(qint64 &arrivalNs);
+    void sendDelayedFcodeResponse(const char *fcodeResponse, int fieldDelay);
+    void scheduleEvent(EventScheduler::eventType type, int fieldDelay);
+    bool isTransmissionDelayOn(void);
 
     QString getFrameNumber(void);
     QString getStopRegister(void);
@@ -62,7 +75,10 @@ public:
     QString getVideoOverlayMode(void);
 
 private:
-    FrameViewerDialog *frameViewer;
+    // The disc position comes from the frame source; the frame viewer
+    // dialogue is only created when no other source is given
+    FrameViewerDialog *frameViewerDialog;
+    FrameSource *frameViewer;
 
     enum class playerDirection {
         forward,
@@ -137,14 +153,70 @@ private:
     discType currentDiscType;
     videoOverlayType videoOverlayMode;
 
-    QByteArray responseToFcode;
-    bool responseToFcodeWaiting;
+    // Responses waiting to be sent, in order, each with the arrival time
+    // of the F-code that caused it (zero for register events)
+    struct Response {
+        QByteArray text;
+        qint64 arrivalNs;
+    };
+    QQueue<Response> responses;
+    void postResponse(const QByteArray &response);
+    void postResponse(const QByteArray &response, qint64 arrivalNs);
+
+    // Arrival time of the F-code being handled
+    qint64 fcodeArrivalNs;
 
     QByteArray currentUserCode;
 
-    QByteArray delayedFcodeResponse;
-    int delayedFcodeCounter;
-    bool delayedFcodePlayFlag;
+    // Emulated time in PAL fields
+    EmulationClock *clock;
+    qint64 polledField;
+
+    // Pending timed actions, and whether audio and video are muted (during
+    // a search)
+    EventScheduler events;
+    bool searchMute;
+
+    SeekModel seekModel;
+    void searchPicture(qint64 picture, const char *response, bool playAfterSearch);
+
+    void runEvent(const EventScheduler::Event &event);
+
+    // Play moves one picture every two PAL fields at normal speed; the
+    // current play rate is playRateFrames pictures every playRateFields
+    // fields
+    static const qint64 fieldsPerFrame = 2;
+    qint64 playRateFrames;
+    qint64 playRateFields;
+    void setPlayRate(qint64 frames, qint64 fields);
+
+    // Fast and slow motion speeds set by SxxxF and SxxxS (2 is normal speed)
+    int fastSpeed;
+    int slowSpeed;
+
+    void scheduleRegisterEvents(void);
+    qint64 registerCrossingField(qint64 registerFrame, qint64 frame, qint64 field, bool playing) const;
+
+    // F-code dispatch table: one row per opcode, in opcode order, checked
+    // against the opcodes and the grammar table at compile time.  The call
+    // templates adapt each handler to the decoded command
+    struct FcodeHandler {
+        FcodeCommand::opcodeType opcode;
+        void (PlayerEmulator::*handler)(const FcodeCommand &command);
+    };
+    static const FcodeHandler fcodeHandlers[];
+    static const size_t fcodeHandlerCount;
+    static constexpr bool fcodeHandlersInOrder(size_t index);
+    static constexpr bool fcodeGrammarHandled(size_t row);
+
+    template <void (PlayerEmulator::*handler)(void)>
+    void callFcode(const FcodeCommand &) { (this->*handler)(); }
+    template <void (PlayerEmulator::*handler)(int)>
+    void callFcodeX(const FcodeCommand &command) { (this->*handler)(command.x); }
+    template <void (PlayerEmulator::*handler)(int, int)>
+    void callFcodeXY(const FcodeCommand &command) { (this->*handler)(command.x, command.y); }
+    template <void (PlayerEmulator::*handler)(char)>
+    void callFcodeParameter(const FcodeCommand &command) { (this->*handler)(command.parameter); }
 
     // F-code handling functions
     void fcodeSoundInsert(int x, int y);
@@ -200,7 +272,7 @@ private:
     void fcodePlayReverseAndJumpReverse(int x, int y);
     void fcodeGotoChapterAndHalt(int x);
     void fcodeGotoChapterAndPlay(int x);
-    void fcodePlayChapterSequence(QByteArray sequence);
+    void fcodePlayChapterSequence(const FcodeCommand &command);
     void fcodeSetFastSpeed(int x);
     void fcodeSetSlowSpeed(int x);
     void fcodeGotoTimeCode(int x, int y);
@@ -210,7 +282,7 @@ private:
     void fcodeFastForward(void);
     void fcodeFastReverse(void);
     void fcodeClear(void);
-    void fcodeVideoOverlay(QByteRef parameter);
+    void fcodeVideoOverlay(char parameter);
     void fcodeAudio1fromInternal(void);
     void fcodeAudio1fromExternal(void);
     void fcodeVideoFromInternal(void);
@@ -0,0 +1,97 @@
+/************************************************************************
+
+    playersdialog.cpp
+
+    Hosted players dialogue functions
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#include "playersdialog.h"
+
+PlayersDialog::PlayersDialog(SessionPool *pool, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::PlayersDialog)
+{
+    ui->setupUi(this);
+    sessionPool = pool;
+
+    // Set up the table columns
+    QStringList headings;
+    headings << tr("Endpoint") << tr("Frame") << tr("Status") << tr("STOP") << tr("INFO")
+             << tr("F-codes") << tr("Multi reads") << tr("Discarded") << tr("Last F-code") << tr("Last response") << tr("Latency (us)") << tr("Disc image");
+    ui->sessionTable->setColumnCount(headings.size());
+    ui->sessionTable->setHorizontalHeaderLabels(headings);
+    ui->sessionTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+    // Refresh the table a few times a second while the dialogue is open
+    refreshTimer = new QTimer(this);
+    connect(refreshTimer, &QTimer::timeout, this, &PlayersDialog::updateTable);
+    refreshTimer->start(250);
+}
+
+PlayersDialog::~PlayersDialog()
+{
+    delete ui;
+}
+
+// Copy the status of each session into the table
+void PlayersDialog::updateTable(void)
+{
+    if (!isVisible()) return;
+
+    int rows = sessionPool->count();
+    ui->sessionTable->setRowCount(rows);
+
+    for (int row = 0; row < rows; row++) {
+        PlayerSession::Status status = sessionPool->status(row);
+
+        setCell(row, 0, status.endpoint);
+        setCell(row, 1, status.frameNumber);
+        setCell(row, 2, status.connected ? status.playerStatus : tr("Error: ") + status.error);
+        setCell(row, 3, status.stopRegister);
+        setCell(row, 4, status.infoRegister);
+        setCell(row, 5, QString::number(status.fcodeCount));
+        setCell(row, 6, QString::number(status.multiCommandReads));
+        setCell(row, 7, tr("%1 bytes (%2 tags)").arg(status.discardedBytes).arg(status.malformedTags));
+        setCell(row, 8, status.lastFcode);
+        setCell(row, 9, status.lastResponse);
+        setCell(row, 10, QString::number(status.latencyUs));
+        setCell(row, 11, status.discImage);
+    }
+}
+
+void PlayersDialog::setCell(int row, int column, const QString &text)
+{
+    QTableWidgetItem *item = ui->sessionTable->item(row, column);
+
+    if (!item) {
+        item = new QTableWidgetItem;
+        ui->sessionTable->setItem(row, column, item);
+    }
+    if (item->text() != text) item->setText(text);
+}
+
+void PlayersDialog::on_closeButton_clicked()
+{
+    // Hide the dialogue
+    hide();
+}
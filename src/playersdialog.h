@@ -0,0 +1,65 @@
+/************************************************************************
+
+    playersdialog.h
+
+    Hosted players dialogue function header
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#ifndef PLAYERSDIALOG_H
+#define PLAYERSDIALOG_H
+
+#include <QDialog>
+#include <QTimer>
+#include <QTableWidget>
+#include <QHeaderView>
+
+#include "ui_playersdialog.h"
+#include "sessionpool.h"
+
+namespace Ui {
+class PlayersDialog;
+}
+
+// Compact status table with one row per hosted player session
+class PlayersDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit PlayersDialog(SessionPool *pool, QWidget *parent = 0);
+    ~PlayersDialog();
+
+private slots:
+    void updateTable(void);
+    void on_closeButton_clicked();
+
+private:
+    Ui::PlayersDialog *ui;
+
+    SessionPool *sessionPool;
+    QTimer *refreshTimer;
+
+    void setCell(int row, int column, const QString &text);
+};
+
+#endif // PLAYERSDIALOG_H
@@ -0,0 +1,269 @@
+/************************************************************************
+
+    playersession.cpp
+
+    Hosted player session functions
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#include "playersession.h"
+
+PlayerSession::PlayerSession(const SettingsDialog::Settings &settings, const QString &discImage, QObject *parent) :
+    QObject(parent),
+    settings(settings),
+    discImage(discImage)
+{
+    // Everything else is created in the session's thread by start()
+    ioWorker = nullptr;
+    tagDemux = nullptr;
+    chunkArrivalNs = 0;
+    frameSource = nullptr;
+    player = nullptr;
+    clock = nullptr;
+
+    currentStatus.connected = false;
+    currentStatus.discImage = discImage;
+    currentStatus.fcodeCount = 0;
+    currentStatus.multiCommandReads = 0;
+    currentStatus.discardedBytes = 0;
+    currentStatus.malformedTags = 0;
+    currentStatus.latencyUs = 0;
+}
+
+PlayerSession::~PlayerSession()
+{
+    stop();
+
+    delete player;
+    delete frameSource;
+    delete tagDemux;
+}
+
+// Return a copy of the session status (any thread)
+PlayerSession::Status PlayerSession::status(void) const
+{
+    QMutexLocker locker(&statusMutex);
+    return currentStatus;
+}
+
+void PlayerSession::setClock(EmulationClock *emulationClock)
+{
+    clock = emulationClock;
+}
+
+// Parse "<transport>[:<address>][,<disc image>]" where transport is one of
+// serial, termios, pty, local, tcp or shm
+bool PlayerSession::parseSpecification(const QString &specification, SettingsDialog::Settings &settings,
+                                       QString &discImage, QString &error)
+{
+    QString endpoint = specification.section(',', 0, 0);
+    QString transport = endpoint.section(':', 0, 0);
+    QString address = endpoint.section(':', 1);
+    discImage = specification.section(',', 1);
+
+    if (transport == "serial") {
+        settings.transport = SettingsDialog::transportType::qtSerialPort;
+        settings.name = address;
+#ifdef Q_OS_LINUX
+    } else if (transport == "termios") {
+        settings.transport = SettingsDialog::transportType::nativeTermios;
+        settings.name = address;
+    } else if (transport == "pty") {
+        settings.transport = SettingsDialog::transportType::pseudoTerminal;
+    } else if (transport == "shm") {
+        settings.transport = SettingsDialog::transportType::sharedMemory;
+        settings.address = address;
+#endif
+    } else if (transport == "local") {
+        settings.transport = SettingsDialog::transportType::localSocket;
+        settings.address = address;
+    } else if (transport == "tcp") {
+        settings.transport = SettingsDialog::transportType::tcpSocket;
+        settings.address = address;
+    } else {
+        error = QString("Unknown player transport: ") + specification;
+        return false;
+    }
+
+    if ((transport == "serial" || transport == "termios") && settings.name.isEmpty()) {
+        error = QString("No serial port given: ") + specification;
+        return false;
+    }
+    if ((transport == "local" || transport == "tcp") && settings.address.isEmpty()) {
+        error = QString("No socket address given: ") + specification;
+        return false;
+    }
+
+    return true;
+}
+
+// Create the emulation and open the transport (session thread)
+bool PlayerSession::start(void)
+{
+    frameSource = new VirtualFrameSource;
+    frameSource->setClock(clock);
+    player = new PlayerEmulator(frameSource);
+    player->setClock(clock);
+    if (!discImage.isEmpty()) player->loadDiscImage(discImage);
+
+    tagDemux = new TagDemux;
+    tagDemux->addTag("UCD", [this](const char *payload, size_t length) {
+        if (length > 0) player->receiveUserCode(QByteArray(payload, static_cast<int>(length)));
+    });
+    tagDemux->addTag("FCODE", [this](const char *payload, size_t length) {
+        if (length == 0) return;
+
+        // Handle the queued F-codes rather than dropping any from a large read
+        if (fcodeQueue.isFull()) handleQueuedFcodes();
+        fcodeQueue.push(payload, length, chunkArrivalNs);
+    });
+
+    // The I/O worker shares the session's thread, so its slots are called
+    // directly rather than through queued invocations
+    ioWorker = new SerialIoWorker(this);
+    ioWorker->setSettings(settings);
+    connect(ioWorker, &SerialIoWorker::dataReceived, this, &PlayerSession::readData);
+    // Errors are queued so that the transport is not closed while it is
+    // still emitting the error
+    connect(ioWorker, &SerialIoWorker::portError, this, &PlayerSession::handleError, Qt::QueuedConnection);
+
+    bool opened = ioWorker->openPort();
+
+    QMutexLocker locker(&statusMutex);
+    currentStatus.connected = opened;
+    currentStatus.endpoint = opened ? ioWorker->endpointName() : settings.name + settings.address;
+    currentStatus.error = opened ? QString() : ioWorker->errorString();
+
+    return opened;
+}
+
+// Close the transport (session thread)
+void PlayerSession::stop(void)
+{
+    if (!ioWorker) return;
+
+    ioWorker->closePort();
+    delete ioWorker;
+    ioWorker = nullptr;
+
+    QMutexLocker locker(&statusMutex);
+    currentStatus.connected = false;
+}
+
+// Run one emulation step (called every field by the pool thread's poller)
+void PlayerSession::poll(qint64 field)
+{
+    if (!player) return;
+
+    player->poll(field);
+    sendFcodeResponses();
+    updateStatus();
+}
+
+// Field of the player's next scheduled event, or -1 (session thread)
+qint64 PlayerSession::nextEventField(void) const
+{
+    return player ? player->nextEventField() : -1;
+}
+
+// Process received data (session thread)
+void PlayerSession::readData(void)
+{
+    // Host traffic holds a virtual clock at the real field rate
+    if (clock) clock->noteActivity();
+
+    QByteArray data;
+    qint64 arrivalNs;
+
+    while (ioWorker && ioWorker->readChunk(data, arrivalNs)) {
+        chunkArrivalNs = arrivalNs;
+        fcodeQueue.beginRead();
+        tagDemux->putData(data.constData(), static_cast<size_t>(data.size()));
+        fcodeQueue.endRead();
+
+        handleQueuedFcodes();
+    }
+
+    // Send any responses immediately rather than waiting for the next poll
+    sendFcodeResponses();
+}
+
+// Handle every queued F-code in order, sending its responses before the
+// next F-code is handled
+void PlayerSession::handleQueuedFcodes(void)
+{
+    while (const FcodeQueue::Command *command = fcodeQueue.front()) {
+        handleFcode(QByteArray(command->text, static_cast<int>(command->length)), command->arrivalNs);
+        fcodeQueue.pop();
+        sendFcodeResponses();
+    }
+}
+
+// Pass an F-code to the player emulator
+void PlayerSession::handleFcode(const QByteArray &fcode, qint64 arrivalNs)
+{
+    player->receiveFcode(fcode, arrivalNs);
+
+    QMutexLocker locker(&statusMutex);
+    currentStatus.lastFcode = QString(fcode);
+    currentStatus.fcodeCount++;
+    currentStatus.multiCommandReads = fcodeQueue.multiCommandReads();
+}
+
+// Pass every waiting F-code response to the transport, in order
+void PlayerSession::sendFcodeResponses(void)
+{
+    qint64 arrivalNs;
+    QByteArray response;
+
+    while (!(response = player->sendFcodeResponse(arrivalNs)).isEmpty()) {
+        if (!ioWorker) continue;
+
+        ioWorker->queueResponse(response + "\r", player->isTransmissionDelayOn(), arrivalNs);
+
+        QMutexLocker locker(&statusMutex);
+        currentStatus.lastResponse = QString(response);
+    }
+}
+
+// Handle a critical transport error (session thread)
+void PlayerSession::handleError(QString error)
+{
+    qDebug() << "PlayerSession::handleError():" << currentStatus.endpoint << error;
+    stop();
+
+    QMutexLocker locker(&statusMutex);
+    currentStatus.error = error;
+}
+
+// Take a snapshot of the player state for the status view
+void PlayerSession::updateStatus(void)
+{
+    QMutexLocker locker(&statusMutex);
+    currentStatus.frameNumber = player->getFrameNumber();
+    currentStatus.playerStatus = player->getStatus();
+    currentStatus.stopRegister = player->getStopRegister();
+    currentStatus.infoRegister = player->getInfoRegister();
+    currentStatus.discardedBytes = tagDemux->discardedBytes();
+    currentStatus.malformedTags = tagDemux->malformedTags();
+    if (ioWorker) currentStatus.latencyUs = ioWorker->lastResponseLatencyUs();
+}
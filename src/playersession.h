@@ -0,0 +1,114 @@
+/************************************************************************
+
+    playersession.h
+
+    Hosted player session function header
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#ifndef PLAYERSESSION_H
+#define PLAYERSESSION_H
+
+#include <QObject>
+#include <QMutex>
+#include <QDebug>
+
+#include "settingsdialog.h"
+#include "serialioworker.h"
+#include "tagdemux.h"
+#include "fcodequeue.h"
+#include "playeremulator.h"
+#include "virtualframesource.h"
+
+// One emulated player hosted alongside the main window's player.  A
+// session owns its own transport, tag demultiplexer and emulation; it lives in a
+// SessionPool worker thread and plays its disc image on a virtual frame
+// source rather than a QMediaPlayer.
+class PlayerSession : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Snapshot of the session for the status view (any thread)
+    struct Status {
+        bool connected;
+        QString endpoint;
+        QString discImage;
+        QString frameNumber;
+        QString playerStatus;
+        QString stopRegister;
+        QString infoRegister;
+        QString lastFcode;
+        QString lastResponse;
+        qint64 fcodeCount;
+        quint64 multiCommandReads;
+        quint64 discardedBytes;
+        quint64 malformedTags;
+        qint64 latencyUs;
+        QString error;
+    };
+
+    explicit PlayerSession(const SettingsDialog::Settings &settings, const QString &discImage, QObject *parent = nullptr);
+    ~PlayerSession();
+
+    Status status(void) const;
+
+    // Emulated time for the session (must be called before start)
+    void setClock(EmulationClock *emulationClock);
+
+    // Parse a player specification such as "tcp:4151,/path/to/disc.mp4"
+    static bool parseSpecification(const QString &specification, SettingsDialog::Settings &settings,
+                                   QString &discImage, QString &error);
+
+public slots:
+    // Executed in the session's thread
+    bool start(void);
+    void stop(void);
+    void poll(qint64 field);
+    qint64 nextEventField(void) const;
+
+private slots:
+    void readData(void);
+    void handleError(QString error);
+
+private:
+    SettingsDialog::Settings settings;
+    QString discImage;
+
+    SerialIoWorker *ioWorker;
+    TagDemux *tagDemux;
+    FcodeQueue fcodeQueue;
+    qint64 chunkArrivalNs;
+    VirtualFrameSource *frameSource;
+    PlayerEmulator *player;
+    EmulationClock *clock;
+
+    mutable QMutex statusMutex;
+    Status currentStatus;
+
+    void handleQueuedFcodes(void);
+    void handleFcode(const QByteArray &fcode, qint64 arrivalNs);
+    void sendFcodeResponses(void);
+    void updateStatus(void);
+};
+
+#endif // PLAYERSESSION_H
@@ -0,0 +1,94 @@
+/************************************************************************
+
+    ptytransport.cpp
+
+    Pseudo-terminal transport functions
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#include "ptytransport.h"
+
+#ifdef Q_OS_LINUX
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+PtyTransport::PtyTransport(const SettingsDialog::Settings &settings, QObject *parent) :
+    TermiosTransport(settings, parent)
+{
+    slaveFd = -1;
+}
+
+PtyTransport::~PtyTransport()
+{
+    close();
+}
+
+bool PtyTransport::open(void)
+{
+    int master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        lastError = QString("posix_openpt: ") + QString::fromLocal8Bit(strerror(errno));
+        if (master >= 0) ::close(master);
+        return false;
+    }
+
+    slavePath = QString::fromLocal8Bit(ptsname(master));
+
+    // Keep a handle on the slave side so the master does not see a hang-up
+    // (EIO) while no host has the pseudo-terminal open
+    slaveFd = ::open(slavePath.toLocal8Bit().constData(), O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (slaveFd < 0) {
+        lastError = slavePath + ": " + QString::fromLocal8Bit(strerror(errno));
+        ::close(master);
+        return false;
+    }
+
+    // Pass bytes through unaltered, exactly as a raw serial line would
+    struct termios tio;
+    tcgetattr(slaveFd, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slaveFd, TCSANOW, &tio);
+
+    qDebug() << "PtyTransport::open(): BeebSCSI stand-ins can connect to" << slavePath;
+
+    return attach(master);
+}
+
+void PtyTransport::close(void)
+{
+    TermiosTransport::close();
+
+    if (slaveFd >= 0) ::close(slaveFd);
+    slaveFd = -1;
+}
+
+QString PtyTransport::endpointName(void) const
+{
+    return slavePath;
+}
+
+#endif // Q_OS_LINUX
@@ -1,8 +1,8 @@
 /************************************************************************
 
-    usercodeanalyser.h
+    ptytransport.h
 
-    User code analyser function header
+    Pseudo-terminal transport function header
     VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
     Copyright (C) 2017 Simon Inns
 
@@ -25,25 +25,36 @@
 
 ************************************************************************/
 
-#ifndef USERCODEANALYSER_H
-#define USERCODEANALYSER_H
+#ifndef PTYTRANSPORT_H
+#define PTYTRANSPORT_H
 
-#include <QString>
-#include <QByteArray>
-#include <QDebug>
+#include <QtGlobal>
 
-class UserCodeAnalyser
+#ifdef Q_OS_LINUX
+
+#include "termiostransport.h"
+
+// Creates a pseudo-terminal and acts as the player on its master side.
+// A scripted host or BBC Micro emulator opens the slave path as if it was
+// the serial port wired to BeebSCSI.
+class PtyTransport : public TermiosTransport
 {
+    Q_OBJECT
+
 public:
-    UserCodeAnalyser();
+    explicit PtyTransport(const SettingsDialog::Settings &settings, QObject *parent = nullptr);
+    ~PtyTransport();
 
-    void putData(const QByteArray &data);
-    QByteArray getUserCode(void);
+    bool open(void) override;
+    void close(void) override;
 
-private:
-    QString userCodeBuffer;
+    QString endpointName(void) const override;
 
-    QString lastUserCode;
+private:
+    QString slavePath;
+    int slaveFd;
 };
 
-#endif // USERCODEANALYSER_H
+#endif // Q_OS_LINUX
+
+#endif // PTYTRANSPORT_H
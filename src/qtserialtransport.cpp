@@ -0,0 +1,97 @@
+/************************************************************************
+
+    qtserialtransport.cpp
+
+    QSerialPort transport functions
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#include "qtserialtransport.h"
+
+QtSerialTransport::QtSerialTransport(const SettingsDialog::Settings &settings, QObject *parent) :
+    Transport(parent),
+    settings(settings)
+{
+    // Define the serial port
+    serial = new QSerialPort(this);
+
+    // Connect the serial port signals to catch errors
+    connect(serial, static_cast<void (QSerialPort::*)(QSerialPort::SerialPortError)>(&QSerialPort::error), this, &QtSerialTransport::handleError);
+
+    // Pass the serial read and write signals through
+    connect(serial, &QSerialPort::readyRead, this, &Transport::readyRead);
+    connect(serial, &QSerialPort::bytesWritten, this, &Transport::bytesWritten);
+}
+
+QtSerialTransport::~QtSerialTransport()
+{
+    close();
+}
+
+bool QtSerialTransport::open(void)
+{
+    serial->setPortName(settings.name);
+    serial->setBaudRate(settings.baudRate);
+    serial->setDataBits(settings.dataBits);
+    serial->setParity(settings.parity);
+    serial->setStopBits(settings.stopBits);
+    serial->setFlowControl(settings.flowControl);
+
+    return serial->open(QIODevice::ReadWrite);
+}
+
+void QtSerialTransport::close(void)
+{
+    if (serial->isOpen()) serial->close();
+}
+
+bool QtSerialTransport::isOpen(void) const
+{
+    return serial->isOpen();
+}
+
+QByteArray QtSerialTransport::readAll(void)
+{
+    return serial->readAll();
+}
+
+qint64 QtSerialTransport::write(const QByteArray &data)
+{
+    return serial->write(data);
+}
+
+QString QtSerialTransport::errorString(void) const
+{
+    return serial->errorString();
+}
+
+QString QtSerialTransport::endpointName(void) const
+{
+    return serial->portName();
+}
+
+// Handle an error signal from the serial port
+void QtSerialTransport::handleError(QSerialPort::SerialPortError error)
+{
+    // Only critical errors are passed on
+    if (error == QSerialPort::ResourceError) emit fatalError(serial->errorString());
+}
@@ -0,0 +1,61 @@
+/************************************************************************
+
+    qtserialtransport.h
+
+    QSerialPort transport function header
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#ifndef QTSERIALTRANSPORT_H
+#define QTSERIALTRANSPORT_H
+
+#include <QtSerialPort/QSerialPort>
+
+#include "transport.h"
+
+class QtSerialTransport : public Transport
+{
+    Q_OBJECT
+
+public:
+    explicit QtSerialTransport(const SettingsDialog::Settings &settings, QObject *parent = nullptr);
+    ~QtSerialTransport();
+
+    bool open(void) override;
+    void close(void) override;
+    bool isOpen(void) const override;
+
+    QByteArray readAll(void) override;
+    qint64 write(const QByteArray &data) override;
+
+    QString errorString(void) const override;
+    QString endpointName(void) const override;
+
+private slots:
+    void handleError(QSerialPort::SerialPortError error);
+
+private:
+    QSerialPort *serial;
+    SettingsDialog::Settings settings;
+};
+
+#endif // QTSERIALTRANSPORT_H
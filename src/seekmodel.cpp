@@ -0,0 +1,143 @@
+/************************************************************************
+
+    seekmodel.cpp
+
+    Optical pickup seek time model
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#include "seekmodel.h"
+
+#include <QSettings>
+
+#include <cmath>
+
+// Figures for a standard 30 cm LaserVision disc and the VP415 sled
+SeekModel::Profile SeekModel::defaultProfile(void)
+{
+    Profile profile;
+    profile.instantJumpTracks = 50;
+    profile.trackPitchUm = 1.6;
+    profile.innerRadiusMm = 55.0;
+    profile.sledAcceleration = 0.5;
+    profile.sledMaximumSpeed = 0.1;
+    profile.settleMs = 200.0;
+    profile.clvSpindleMsPerMm = 12.0;
+    return profile;
+}
+
+SeekModel::Profile SeekModel::loadProfile(void)
+{
+    QSettings store;
+    Profile profile = defaultProfile();
+
+    store.beginGroup("seek");
+    profile.instantJumpTracks = store.value("instantJumpTracks", profile.instantJumpTracks).toInt();
+    profile.trackPitchUm = store.value("trackPitchUm", profile.trackPitchUm).toDouble();
+    profile.innerRadiusMm = store.value("innerRadiusMm", profile.innerRadiusMm).toDouble();
+    profile.sledAcceleration = store.value("sledAcceleration", profile.sledAcceleration).toDouble();
+    profile.sledMaximumSpeed = store.value("sledMaximumSpeed", profile.sledMaximumSpeed).toDouble();
+    profile.settleMs = store.value("settleMs", profile.settleMs).toDouble();
+    profile.clvSpindleMsPerMm = store.value("clvSpindleMsPerMm", profile.clvSpindleMsPerMm).toDouble();
+    store.endGroup();
+
+    return profile;
+}
+
+void SeekModel::saveProfile(const Profile &profile)
+{
+    QSettings store;
+
+    store.beginGroup("seek");
+    store.setValue("instantJumpTracks", profile.instantJumpTracks);
+    store.setValue("trackPitchUm", profile.trackPitchUm);
+    store.setValue("innerRadiusMm", profile.innerRadiusMm);
+    store.setValue("sledAcceleration", profile.sledAcceleration);
+    store.setValue("sledMaximumSpeed", profile.sledMaximumSpeed);
+    store.setValue("settleMs", profile.settleMs);
+    store.setValue("clvSpindleMsPerMm", profile.clvSpindleMsPerMm);
+    store.endGroup();
+}
+
+SeekModel::SeekModel(const Profile &profile)
+{
+    setProfile(profile);
+}
+
+// Values that would stop the sled from moving fall back to the defaults
+void SeekModel::setProfile(const Profile &profile)
+{
+    Profile defaults = defaultProfile();
+
+    currentProfile = profile;
+    if (currentProfile.instantJumpTracks < 0) currentProfile.instantJumpTracks = defaults.instantJumpTracks;
+    if (currentProfile.trackPitchUm <= 0.0) currentProfile.trackPitchUm = defaults.trackPitchUm;
+    if (currentProfile.innerRadiusMm <= 0.0) currentProfile.innerRadiusMm = defaults.innerRadiusMm;
+    if (currentProfile.sledAcceleration <= 0.0) currentProfile.sledAcceleration = defaults.sledAcceleration;
+    if (currentProfile.sledMaximumSpeed <= 0.0) currentProfile.sledMaximumSpeed = defaults.sledMaximumSpeed;
+    if (currentProfile.settleMs < 0.0) currentProfile.settleMs = 0.0;
+    if (currentProfile.clvSpindleMsPerMm < 0.0) currentProfile.clvSpindleMsPerMm = 0.0;
+}
+
+const SeekModel::Profile &SeekModel::profile(void) const
+{
+    return currentProfile;
+}
+
+double SeekModel::trackOf(int64_t frameNumber, discType type) const
+{
+    double frame = frameNumber > 1 ? static_cast<double>(frameNumber - 1) : 0.0;
+    if (type == discType::CAV) return frame;
+
+    // A CLV track at radius r holds r / r0 pictures, so the pictures up to
+    // track n add up to n + n^2 * pitch / (2 * r0); solve that for n
+    double tracksPerRadius = currentProfile.innerRadiusMm * 1000.0 / currentProfile.trackPitchUm;
+    return tracksPerRadius * (std::sqrt(1.0 + 2.0 * frame / tracksPerRadius) - 1.0);
+}
+
+double SeekModel::seekMs(int64_t fromFrame, int64_t toFrame, discType type) const
+{
+    double tracks = std::fabs(trackOf(toFrame, type) - trackOf(fromFrame, type));
+    if (tracks <= currentProfile.instantJumpTracks) return 0.0;
+
+    // The sled accelerates to its maximum speed, runs and brakes again; a
+    // short move brakes before reaching the maximum speed
+    double distance = tracks * currentProfile.trackPitchUm / 1000000.0;
+    double acceleration = currentProfile.sledAcceleration;
+    double maximumSpeed = currentProfile.sledMaximumSpeed;
+    double moveSeconds;
+
+    if (distance < maximumSpeed * maximumSpeed / acceleration) moveSeconds = 2.0 * std::sqrt(distance / acceleration);
+    else moveSeconds = distance / maximumSpeed + maximumSpeed / acceleration;
+
+    double milliseconds = moveSeconds * 1000.0 + currentProfile.settleMs;
+
+    // The CLV spindle must also change speed to suit the new radius
+    if (type == discType::CLV) milliseconds += distance * 1000.0 * currentProfile.clvSpindleMsPerMm;
+
+    return milliseconds;
+}
+
+int64_t SeekModel::seekFields(int64_t fromFrame, int64_t toFrame, discType type) const
+{
+    return static_cast<int64_t>(std::ceil(seekMs(fromFrame, toFrame, type) / 20.0));
+}
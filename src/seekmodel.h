@@ -0,0 +1,81 @@
+/************************************************************************
+
+    seekmodel.h
+
+    Optical pickup seek time model header
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#ifndef SEEKMODEL_H
+#define SEEKMODEL_H
+
+#include <cstdint>
+
+// Works out how long the VP415 takes to search from one picture to
+// another.  Pictures are mapped to tracks (one picture per track on CAV
+// discs; on CLV discs the number of pictures per track grows with the
+// radius).  Searches within the instant jump region are made by the
+// tracking mirror during the video blanking and take no time; longer ones
+// move the sled with a trapezoidal speed profile and then wait for the
+// pickup to settle (and, on CLV discs, for the spindle to change speed).
+class SeekModel
+{
+public:
+    enum class discType {
+        CAV,
+        CLV
+    };
+
+    struct Profile {
+        int instantJumpTracks;          // Tracks reachable by the mirror alone
+        double trackPitchUm;            // Distance between tracks
+        double innerRadiusMm;           // Radius of the first picture
+        double sledAcceleration;        // m/s^2
+        double sledMaximumSpeed;        // m/s
+        double settleMs;                // Focus and tracking lock after a sled move
+        double clvSpindleMsPerMm;       // CLV spindle speed change per mm of radius
+    };
+
+    static Profile defaultProfile(void);
+
+    // Read and write the profile in the application settings ("seek" group)
+    static Profile loadProfile(void);
+    static void saveProfile(const Profile &profile);
+
+    explicit SeekModel(const Profile &profile = defaultProfile());
+
+    void setProfile(const Profile &profile);
+    const Profile &profile(void) const;
+
+    // Track (counted from the first picture) holding a picture
+    double trackOf(int64_t frameNumber, discType type) const;
+
+    // Search time in milliseconds and in PAL fields (rounded up); zero for
+    // a search within the instant jump region
+    double seekMs(int64_t fromFrame, int64_t toFrame, discType type) const;
+    int64_t seekFields(int64_t fromFrame, int64_t toFrame, discType type) const;
+
+private:
+    Profile currentProfile;
+};
+
+#endif // SEEKMODEL_H
@@ -0,0 +1,276 @@
+/************************************************************************
+
+    serialioworker.cpp
+
+    Serial I/O worker functions
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#include "serialioworker.h"
+
+SerialIoWorker::SerialIoWorker(QObject *parent) : QObject(parent)
+{
+    // The transport is created in the I/O thread when the port is opened
+    transport = nullptr;
+
+    // Responses are written through the paced writer so that the VP415
+    // transmission delay can be honoured
+    writer = new PacedWriter(this);
+
+    // No notification or flush is outstanding
+    notifyPending = false;
+    flushPending = false;
+    bytesReceived = 0;
+    backlogArrivalNs = 0;
+    directRead = false;
+    closing = false;
+}
+
+SerialIoWorker::~SerialIoWorker()
+{
+    closePort();
+}
+
+// Store the serial settings (GUI thread - must be called before openPort)
+void SerialIoWorker::setSettings(const SettingsDialog::Settings &newSettings)
+{
+    settings = newSettings;
+}
+
+// Return the last error reported by the serial port
+QString SerialIoWorker::errorString() const
+{
+    return lastError;
+}
+
+// Return where the host should connect to the open transport
+QString SerialIoWorker::endpointName() const
+{
+    return endpoint;
+}
+
+// Take the next received chunk of serial data and its arrival time (GUI thread)
+bool SerialIoWorker::readChunk(QByteArray &data, qint64 &arrivalNs)
+{
+    // Clear the notification flag before draining so that data arriving
+    // during the drain raises a new notification
+    notifyPending.store(false, std::memory_order_release);
+
+    Chunk chunk;
+    if (!receiveQueue.pop(chunk)) return false;
+
+    data = chunk.data;
+    arrivalNs = chunk.arrivalNs;
+    return true;
+}
+
+// Queue an F-code response for transmission (GUI thread).  arrivalNs is the
+// arrival time of the F-code that caused it, or zero if there was none
+bool SerialIoWorker::queueResponse(const QByteArray &data, bool paced, qint64 arrivalNs)
+{
+    Response response;
+    response.data = data;
+    response.paced = paced;
+    response.arrivalNs = arrivalNs;
+
+    if (!transmitQueue.push(response)) {
+        qWarning() << "SerialIoWorker::queueResponse(): Transmit queue is full - response dropped";
+        return false;
+    }
+
+    // Ask the I/O thread to write out the queued responses (unless it is
+    // already due to)
+    if (!flushPending.exchange(true, std::memory_order_acq_rel)) {
+        QMetaObject::invokeMethod(this, "flushResponses", Qt::QueuedConnection);
+    }
+    return true;
+}
+
+// Bytes waiting to be sent, including those held by the transport (any thread)
+qint64 SerialIoWorker::outputQueueDepth(void) const
+{
+    return writer->queuedBytes();
+}
+
+// Longest time the link has held data without sending any (any thread)
+qint64 SerialIoWorker::maximumStallMs(void) const
+{
+    return writer->maximumStallMs();
+}
+
+// Throughput counters for the link (any thread)
+qint64 SerialIoWorker::totalBytesReceived(void) const
+{
+    return bytesReceived.load(std::memory_order_relaxed);
+}
+
+qint64 SerialIoWorker::totalBytesSent(void) const
+{
+    return writer->totalBytesWritten();
+}
+
+// Receive-to-response latency measured from the wire (any thread)
+qint64 SerialIoWorker::lastResponseLatencyUs(void) const
+{
+    return writer->lastResponseLatencyUs();
+}
+
+qint64 SerialIoWorker::maximumResponseLatencyUs(void) const
+{
+    return writer->maximumResponseLatencyUs();
+}
+
+// Open the transport selected in the settings (I/O thread)
+bool SerialIoWorker::openPort(void)
+{
+    closePort();
+
+    transport = Transport::create(settings, this);
+
+    // Connect the transport signals to catch errors and received data.  A
+    // transport with its own reader thread calls readData() directly from
+    // that thread, saving a hop through the I/O thread's event loop.
+    directRead = transport->hasReaderThread();
+    closing = false;
+    connect(transport, &Transport::fatalError, this, &SerialIoWorker::handleError);
+    connect(transport, &Transport::readyRead, this, &SerialIoWorker::readData,
+            directRead ? Qt::DirectConnection : Qt::AutoConnection);
+
+    if (!transport->open()) {
+        lastError = transport->errorString();
+        delete transport;
+        transport = nullptr;
+        return false;
+    }
+
+    endpoint = transport->endpointName();
+    writer->setTransport(transport);
+    writer->resetCounters();
+    lastError.clear();
+    return true;
+}
+
+// Close the transport (I/O thread)
+void SerialIoWorker::closePort(void)
+{
+    writer->setTransport(nullptr);
+
+    // Stop a reader thread waiting for space in the receive queue
+    closing = true;
+
+    if (transport) {
+        transport->close();
+        delete transport;
+        transport = nullptr;
+    }
+
+    // Discard anything that was waiting to be sent
+    Response discard;
+    while (transmitQueue.pop(discard)) {}
+    receiveBacklog.clear();
+}
+
+// Write all queued F-code responses to the serial port (I/O thread)
+void SerialIoWorker::flushResponses(void)
+{
+    Response response;
+    QByteArray batch;
+    QVector<PacedWriter::Response> batchResponses;
+    bool batchPaced = false;
+
+    // Clear the flag before draining so that a response queued during the
+    // drain requests another flush
+    flushPending.store(false, std::memory_order_release);
+
+    // Coalesce adjacent responses into as few writes as possible; the
+    // writer times each one to its last byte reaching the transport
+    while (transmitQueue.pop(response)) {
+        if (!batch.isEmpty() && response.paced != batchPaced) {
+            writer->write(batch, batchPaced, batchResponses);
+            batch.clear();
+            batchResponses.clear();
+        }
+        batch.append(response.data);
+        batchPaced = response.paced;
+
+        if (response.arrivalNs > 0) {
+            PacedWriter::Response timing;
+            timing.end = batch.size();
+            timing.arrivalNs = response.arrivalNs;
+            batchResponses.append(timing);
+        }
+    }
+
+    if (!batch.isEmpty()) writer->write(batch, batchPaced, batchResponses);
+}
+
+// Read all available data from the serial port (I/O thread, or the
+// transport's reader thread)
+void SerialIoWorker::readData(void)
+{
+    if (transport) {
+        // The transport stamps the data where it was read from the device;
+        // if older data is still waiting, the chunk keeps the earlier time
+        qint64 arrivalNs;
+        QByteArray data = transport->readStamped(arrivalNs);
+        bytesReceived.fetch_add(data.size(), std::memory_order_relaxed);
+
+        if (receiveBacklog.isEmpty()) backlogArrivalNs = arrivalNs;
+        receiveBacklog.append(data);
+    }
+    pushReceivedData();
+}
+
+// Pass received data to the GUI thread (I/O thread, or the transport's
+// reader thread)
+void SerialIoWorker::pushReceivedData(void)
+{
+    if (receiveBacklog.isEmpty()) return;
+
+    Chunk chunk;
+    chunk.data = receiveBacklog;
+    chunk.arrivalNs = backlogArrivalNs;
+
+    // The GUI thread has fallen a long way behind; keep the data and try
+    // again shortly rather than losing it.  A reader thread has no event
+    // loop, so it waits for space instead (which also holds back the host).
+    while (!receiveQueue.push(chunk)) {
+        if (!directRead) {
+            QTimer::singleShot(1, this, &SerialIoWorker::pushReceivedData);
+            return;
+        }
+        if (closing.load(std::memory_order_acquire)) return;
+        std::this_thread::yield();
+    }
+    receiveBacklog.clear();
+
+    // Only signal the GUI thread if it is not already due to drain the queue
+    if (!notifyPending.exchange(true, std::memory_order_acq_rel)) emit dataReceived();
+}
+
+// Handle a critical error from the transport (I/O thread)
+void SerialIoWorker::handleError(QString error)
+{
+    // The GUI thread will close the port
+    lastError = error;
+    emit portError(error);
+}
@@ -0,0 +1,121 @@
+/************************************************************************
+
+    serialioworker.h
+
+    Serial I/O worker function header
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#ifndef SERIALIOWORKER_H
+#define SERIALIOWORKER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QTimer>
+#include <QDebug>
+
+#include <atomic>
+#include <thread>
+
+#include "settingsdialog.h"
+#include "transport.h"
+#include "pacedwriter.h"
+#include "spscqueue.h"
+#include "monotonicclock.h"
+
+// The serial I/O worker lives in its own thread and owns the transport.
+// Received data is passed to the GUI thread through a lock-free queue and
+// F-code responses are passed back through a second lock-free queue, so
+// the timing of the serial link does not depend on the widgets.
+//
+// When the transport has its own reader thread, that thread runs
+// readData() directly and pushes straight into the queue to the GUI
+// thread, rather than waking the I/O thread to do it.
+class SerialIoWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SerialIoWorker(QObject *parent = nullptr);
+    ~SerialIoWorker();
+
+    // Called from the GUI thread
+    void setSettings(const SettingsDialog::Settings &newSettings);
+    QString errorString() const;
+    QString endpointName() const;
+    bool readChunk(QByteArray &data, qint64 &arrivalNs);
+    bool queueResponse(const QByteArray &data, bool paced, qint64 arrivalNs);
+    qint64 outputQueueDepth(void) const;
+    qint64 maximumStallMs(void) const;
+    qint64 totalBytesReceived(void) const;
+    qint64 totalBytesSent(void) const;
+    qint64 lastResponseLatencyUs(void) const;
+    qint64 maximumResponseLatencyUs(void) const;
+
+public slots:
+    // Executed in the I/O thread
+    bool openPort(void);
+    void closePort(void);
+    void flushResponses(void);
+
+signals:
+    void dataReceived(void);
+    void portError(QString error);
+
+private slots:
+    void readData(void);
+    void handleError(QString error);
+
+private:
+    Transport *transport;
+    PacedWriter *writer;
+    SettingsDialog::Settings settings;
+    QString lastError;
+    QString endpoint;
+
+    // Data received from the serial port waiting for the GUI thread, each
+    // chunk stamped with the monotonic time it was read from the transport
+    struct Chunk {
+        QByteArray data;
+        qint64 arrivalNs;
+    };
+    SpscQueue<Chunk, 1024> receiveQueue;
+    QByteArray receiveBacklog;
+    qint64 backlogArrivalNs;
+    std::atomic<bool> notifyPending;
+    std::atomic<qint64> bytesReceived;
+    bool directRead;
+    std::atomic<bool> closing;
+
+    // F-code responses waiting to be written to the serial port
+    struct Response {
+        QByteArray data;
+        bool paced;
+        qint64 arrivalNs;
+    };
+    SpscQueue<Response, 256> transmitQueue;
+    std::atomic<bool> flushPending;
+
+    void pushReceivedData(void);
+};
+
+#endif // SERIALIOWORKER_H
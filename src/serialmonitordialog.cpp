@@ -42,13 +42,15 @@ SerialMonitorDialog::~SerialMonitorDialog()
     delete ui;
 }
 
-void SerialMonitorDialog::putData(const QByteArray &data, bool timeStamp)
+// Show received data (stamped with the time it arrived at the serial port
+// rather than the time the GUI got to it)
+void SerialMonitorDialog::putData(const QByteArray &data, bool timeStamp, qint64 arrivalNs)
 {
     if (timeStamp) {
         // Convert the byte array to a QString and then split based on
         // new lines
         QString dataIn = QString(data);
-        dataIn.replace(QRegExp("\n|\r\n|\r"), tr("\n [") + QTime::currentTime().toString("HH:mm:ss.zzz") + tr("] "));
+        dataIn.replace(QRegExp("\n|\r\n|\r"), tr("\n [") + MonotonicClock::toTime(arrivalNs).toString("HH:mm:ss.zzz") + tr("] "));
 
         // Insert the data to the console widget (adds CR)
         ui->plainTextEdit->insertPlainText(dataIn);
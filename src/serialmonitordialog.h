@@ -32,6 +32,8 @@
 #include <QScrollBar>
 #include <QTime>
 
+#include "monotonicclock.h"
+
 #include "ui_serialmonitordialog.h"
 
 namespace Ui {
@@ -46,7 +48,7 @@ public:
     explicit SerialMonitorDialog(QWidget *parent = nullptr);
     ~SerialMonitorDialog();
 
-    void putData(const QByteArray &data, bool timeStamp);
+    void putData(const QByteArray &data, bool timeStamp, qint64 arrivalNs);
 
 private slots:
     void on_closeButton_clicked();
@@ -0,0 +1,160 @@
+/************************************************************************
+
+    sessionpool.cpp
+
+    Hosted player thread pool functions
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#include "sessionpool.h"
+
+SessionPoller::SessionPoller(EmulationClock *emulationClock, QObject *parent) : QObject(parent)
+{
+    clock = emulationClock;
+    lastPolledField = -1;
+}
+
+void SessionPoller::addSession(PlayerSession *session)
+{
+    sessions.append(session);
+}
+
+// Stop and delete all of the sessions in this thread (pool thread)
+void SessionPoller::removeAll(void)
+{
+    qDeleteAll(sessions);
+    sessions.clear();
+}
+
+// Field ticks arrive as queued events from the clock thread (pool thread)
+void SessionPoller::pollSessions(qint64 field)
+{
+    // After a stall (slow sessions, a busy pool thread) several ticks can
+    // be queued together.  Poll once at the current field and drop the
+    // rest of the backlog; a virtual clock is answered for that field, so
+    // it does not wait for the ticks that are dropped.
+    if (field <= lastPolledField) return;
+    qint64 currentField = clock->currentField();
+    if (currentField > field) field = currentField;
+    lastPolledField = field;
+
+    qint64 nextEventField = -1;
+
+    for (PlayerSession *session : sessions) {
+        session->poll(field);
+
+        qint64 eventField = session->nextEventField();
+        if (eventField >= 0 && (nextEventField < 0 || eventField < nextEventField)) nextEventField = eventField;
+    }
+
+    // A virtual clock waits for every poller before moving on
+    clock->fieldPolled(field, nextEventField);
+}
+
+SessionPool::SessionPool(int threadCount, QObject *parent) : QObject(parent)
+{
+    maximumThreads = threadCount > 0 ? threadCount : qMax(1, QThread::idealThreadCount());
+
+    // Sessions are passed to the pollers through queued invocations
+    qRegisterMetaType<PlayerSession *>("PlayerSession*");
+
+    // The clock only starts ticking once the first session is added
+    clock = new EmulationClock(this);
+}
+
+SessionPool::~SessionPool()
+{
+    stopAll();
+}
+
+// Create a session, open its transport and hand it to a pool thread
+bool SessionPool::addSession(const SettingsDialog::Settings &settings, const QString &discImage, QString &error)
+{
+    int index = sessions.size() % maximumThreads;
+
+    // Threads are only started as they are needed
+    if (index >= threads.size()) {
+        QThread *thread = new QThread(this);
+        SessionPoller *poller = new SessionPoller(clock);
+        poller->moveToThread(thread);
+        connect(clock, &EmulationClock::fieldTick, poller, &SessionPoller::pollSessions);
+        clock->addParticipant();
+        connect(thread, &QThread::finished, poller, &QObject::deleteLater);
+        thread->start(QThread::TimeCriticalPriority);
+
+        threads.append(thread);
+        pollers.append(poller);
+    }
+
+    if (!clock->isRunning()) clock->startClock();
+
+    PlayerSession *session = new PlayerSession(settings, discImage);
+    session->setClock(clock);
+    session->moveToThread(threads[index]);
+
+    bool started = false;
+    QMetaObject::invokeMethod(session, "start", Qt::BlockingQueuedConnection, Q_RETURN_ARG(bool, started));
+
+    if (!started) {
+        error = session->status().error;
+        session->deleteLater();
+        return false;
+    }
+
+    QMetaObject::invokeMethod(pollers[index], "addSession", Qt::BlockingQueuedConnection, Q_ARG(PlayerSession *, session));
+    sessions.append(session);
+    return true;
+}
+
+int SessionPool::count(void) const
+{
+    return sessions.size();
+}
+
+PlayerSession::Status SessionPool::status(int index) const
+{
+    return sessions.at(index)->status();
+}
+
+void SessionPool::setVirtualTime(bool enabled)
+{
+    clock->setVirtualTime(enabled);
+}
+
+// Close every session and stop the pool threads
+void SessionPool::stopAll(void)
+{
+    clock->stopClock();
+
+    for (SessionPoller *poller : pollers) {
+        QMetaObject::invokeMethod(poller, "removeAll", Qt::BlockingQueuedConnection);
+    }
+    sessions.clear();
+
+    for (QThread *thread : threads) {
+        thread->quit();
+        thread->wait();
+    }
+    pollers.clear();
+    qDeleteAll(threads);
+    threads.clear();
+}
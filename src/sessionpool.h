@@ -0,0 +1,90 @@
+/************************************************************************
+
+    sessionpool.h
+
+    Hosted player thread pool function header
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#ifndef SESSIONPOOL_H
+#define SESSIONPOOL_H
+
+#include <QObject>
+#include <QThread>
+#include <QVector>
+#include <QDebug>
+
+#include "playersession.h"
+#include "emulationclock.h"
+
+// Polls every session that lives in one pool thread on each field tick of
+// the pool's emulation clock
+class SessionPoller : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SessionPoller(EmulationClock *emulationClock, QObject *parent = nullptr);
+
+public slots:
+    void addSession(PlayerSession *session);
+    void removeAll(void);
+    void pollSessions(qint64 field);
+
+private:
+    EmulationClock *clock;
+    QVector<PlayerSession *> sessions;
+
+    // Last field polled, so that a backlog of ticks is polled only once
+    qint64 lastPolledField;
+};
+
+// Hosts any number of independent player sessions on a fixed pool of
+// threads (one per CPU core by default).  Sessions are spread across the
+// threads in turn; each thread runs the I/O and emulation of its sessions.
+// All of the sessions share one field clock.
+class SessionPool : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SessionPool(int threadCount = 0, QObject *parent = nullptr);
+    ~SessionPool();
+
+    // Called from the GUI thread
+    bool addSession(const SettingsDialog::Settings &settings, const QString &discImage, QString &error);
+    int count(void) const;
+    PlayerSession::Status status(int index) const;
+    void stopAll(void);
+
+    // Run the sessions on virtual time (before the first session is added)
+    void setVirtualTime(bool enabled);
+
+private:
+    int maximumThreads;
+    EmulationClock *clock;
+    QVector<QThread *> threads;
+    QVector<SessionPoller *> pollers;
+    QVector<PlayerSession *> sessions;
+};
+
+#endif // SESSIONPOOL_H
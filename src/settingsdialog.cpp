@@ -26,6 +26,9 @@
 ************************************************************************/
 
 #include "settingsdialog.h"
+#include "latencyprobe.h"
+
+#include <algorithm>
 
 SettingsDialog::SettingsDialog(QWidget *parent) :
     QDialog(parent),
@@ -34,6 +37,22 @@ SettingsDialog::SettingsDialog(QWidget *parent) :
     ui->setupUi(this);
 
     fillPortsInfo();
+    fillTransportInfo();
+    fillLineInfo();
+
+    // No fault injection by default
+    currentSettings.faults.enabled = false;
+    currentSettings.faults.seed = 1;
+    currentSettings.faults.latencyMs = 0;
+    currentSettings.faults.jitterMs = 0;
+    currentSettings.faults.dropRate = 0.0;
+    currentSettings.faults.corruptRate = 0.0;
+    currentSettings.faults.splitRate = 0.0;
+
+    // Restore the selections from the last run (57600 8N1 with no flow
+    // control on the Qt serial port if nothing has been saved)
+    loadSettings();
+    updateSettings();
 }
 
 SettingsDialog::~SettingsDialog()
@@ -47,6 +66,11 @@ SettingsDialog::Settings SettingsDialog::settings() const
     return currentSettings;
 }
 
+void SettingsDialog::setFaultSettings(const FaultSettings &faults)
+{
+    currentSettings.faults = faults;
+}
+
 void SettingsDialog::fillPortsInfo()
 {
     ui->serialPortInfoListBox->clear();
@@ -62,18 +86,168 @@ void SettingsDialog::fillPortsInfo()
     }
 }
 
+void SettingsDialog::fillTransportInfo()
+{
+    ui->transportListBox->clear();
+    ui->transportListBox->addItem(tr("Qt serial port"), static_cast<int>(transportType::qtSerialPort));
+#ifdef Q_OS_LINUX
+    ui->transportListBox->addItem(tr("Native termios"), static_cast<int>(transportType::nativeTermios));
+    ui->transportListBox->addItem(tr("Pseudo-terminal"), static_cast<int>(transportType::pseudoTerminal));
+#endif
+    ui->transportListBox->addItem(tr("Local socket"), static_cast<int>(transportType::localSocket));
+    ui->transportListBox->addItem(tr("TCP socket"), static_cast<int>(transportType::tcpSocket));
+#ifdef Q_OS_LINUX
+    ui->transportListBox->addItem(tr("Shared memory"), static_cast<int>(transportType::sharedMemory));
+#endif
+
+    ui->pollModeListBox->clear();
+    ui->pollModeListBox->addItem(tr("Event loop"), static_cast<int>(pollMode::eventLoop));
+#ifdef Q_OS_LINUX
+    ui->pollModeListBox->addItem(tr("Epoll thread"), static_cast<int>(pollMode::epoll));
+    ui->pollModeListBox->addItem(tr("Busy-poll thread"), static_cast<int>(pollMode::busyPoll));
+#endif
+}
+
+void SettingsDialog::fillLineInfo()
+{
+    // Standard rates reported by Qt plus the high-speed rates supported by
+    // FTDI/CP210x style adapters; any other rate can be typed in
+    QList<qint32> baudRates = QSerialPortInfo::standardBaudRates();
+    baudRates << 230400 << 460800 << 500000 << 576000 << 921600
+              << 1000000 << 1500000 << 2000000 << 3000000 << 4000000;
+    std::sort(baudRates.begin(), baudRates.end());
+    baudRates.erase(std::unique(baudRates.begin(), baudRates.end()), baudRates.end());
+
+    ui->baudRateListBox->clear();
+    for (qint32 baudRate : baudRates) {
+        if (baudRate >= 1200) ui->baudRateListBox->addItem(QString::number(baudRate));
+    }
+    ui->baudRateListBox->setValidator(new QIntValidator(1, 2147483647, this));
+
+    // Data bits, parity and stop bits
+    ui->lineFormatListBox->clear();
+    ui->lineFormatListBox->addItem(tr("8N1"), QString("8N1"));
+    ui->lineFormatListBox->addItem(tr("8E1"), QString("8E1"));
+    ui->lineFormatListBox->addItem(tr("8O1"), QString("8O1"));
+    ui->lineFormatListBox->addItem(tr("8N2"), QString("8N2"));
+    ui->lineFormatListBox->addItem(tr("7E1"), QString("7E1"));
+    ui->lineFormatListBox->addItem(tr("7O1"), QString("7O1"));
+
+    ui->flowControlListBox->clear();
+    ui->flowControlListBox->addItem(tr("None"), static_cast<int>(QSerialPort::NoFlowControl));
+    ui->flowControlListBox->addItem(tr("RTS/CTS"), static_cast<int>(QSerialPort::HardwareControl));
+}
+
+// Select the combo box entries saved by the last run
+void SettingsDialog::loadSettings()
+{
+    QSettings store;
+    int index;
+
+    store.beginGroup("serial");
+    index = ui->serialPortInfoListBox->findText(store.value("port").toString());
+    if (index >= 0) ui->serialPortInfoListBox->setCurrentIndex(index);
+
+    ui->baudRateListBox->setCurrentText(store.value("baudRate", 57600).toString());
+
+    index = ui->lineFormatListBox->findData(store.value("format", "8N1").toString());
+    if (index >= 0) ui->lineFormatListBox->setCurrentIndex(index);
+
+    index = ui->flowControlListBox->findData(store.value("flowControl", static_cast<int>(QSerialPort::NoFlowControl)).toInt());
+    if (index >= 0) ui->flowControlListBox->setCurrentIndex(index);
+    store.endGroup();
+
+    store.beginGroup("transport");
+    index = ui->transportListBox->findData(store.value("type", static_cast<int>(transportType::qtSerialPort)).toInt());
+    if (index >= 0) ui->transportListBox->setCurrentIndex(index);
+
+    index = ui->pollModeListBox->findData(store.value("polling", static_cast<int>(pollMode::eventLoop)).toInt());
+    if (index >= 0) ui->pollModeListBox->setCurrentIndex(index);
+
+    ui->addressLineEdit->setText(store.value("address", ui->addressLineEdit->text()).toString());
+    store.endGroup();
+}
+
+// Remember the current selections for the next run
+void SettingsDialog::saveSettings()
+{
+    QSettings store;
+
+    store.beginGroup("serial");
+    store.setValue("port", currentSettings.name);
+    store.setValue("baudRate", currentSettings.baudRate);
+    store.setValue("format", ui->lineFormatListBox->currentData().toString());
+    store.setValue("flowControl", static_cast<int>(currentSettings.flowControl));
+    store.endGroup();
+
+    store.beginGroup("transport");
+    store.setValue("type", static_cast<int>(currentSettings.transport));
+    store.setValue("polling", static_cast<int>(currentSettings.polling));
+    store.setValue("address", currentSettings.address);
+    store.endGroup();
+}
+
 void SettingsDialog::updateSettings()
 {
     currentSettings.name = ui->serialPortInfoListBox->currentText();
-    currentSettings.baudRate = QSerialPort::Baud57600;
-    currentSettings.dataBits = QSerialPort::Data8;
-    currentSettings.parity = QSerialPort::NoParity;
-    currentSettings.stopBits = QSerialPort::OneStop;
-    currentSettings.flowControl = QSerialPort::NoFlowControl;
+    currentSettings.transport = static_cast<transportType>(ui->transportListBox->currentData().toInt());
+    currentSettings.polling = static_cast<pollMode>(ui->pollModeListBox->currentData().toInt());
+    currentSettings.address = ui->addressLineEdit->text();
+
+    // Fall back to the VP415's usual rate if the typed rate is not valid
+    bool ok = false;
+    currentSettings.baudRate = ui->baudRateListBox->currentText().toInt(&ok);
+    if (!ok || currentSettings.baudRate <= 0) currentSettings.baudRate = QSerialPort::Baud57600;
+
+    // The format is stored as data bits, parity and stop bits (e.g. "8N1")
+    QString format = ui->lineFormatListBox->currentData().toString();
+    if (format.length() != 3) format = "8N1";
+
+    currentSettings.dataBits = (format.at(0) == '7') ? QSerialPort::Data7 : QSerialPort::Data8;
+
+    switch (format.at(1).toLatin1()) {
+        case 'E': currentSettings.parity = QSerialPort::EvenParity; break;
+        case 'O': currentSettings.parity = QSerialPort::OddParity; break;
+        default: currentSettings.parity = QSerialPort::NoParity; break;
+    }
+
+    currentSettings.stopBits = (format.at(2) == '2') ? QSerialPort::TwoStop : QSerialPort::OneStop;
+    currentSettings.flowControl = static_cast<QSerialPort::FlowControl>(ui->flowControlListBox->currentData().toInt());
 }
 
 void SettingsDialog::on_pushButton_clicked()
 {
     updateSettings();
+    saveSettings();
     hide();
 }
+
+// Compare the receive latency of the Qt and native transports using a
+// pseudo-terminal pair
+void SettingsDialog::on_measureLatencyButton_clicked()
+{
+    updateSettings();
+    Settings probeSettings = currentSettings;
+    probeSettings.faults.enabled = false;
+    QString error;
+
+    ui->latencyLabel->setText(tr("Measuring..."));
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+
+    probeSettings.transport = transportType::qtSerialPort;
+    qint64 qtLatency = LatencyProbe::measureReceiveLatency(probeSettings, 100, error);
+
+    probeSettings.transport = transportType::nativeTermios;
+    qint64 termiosLatency = LatencyProbe::measureReceiveLatency(probeSettings, 100, error);
+
+    QApplication::restoreOverrideCursor();
+
+    if (qtLatency < 0 && termiosLatency < 0) {
+        ui->latencyLabel->setText(error);
+        return;
+    }
+
+    ui->latencyLabel->setText(tr("Qt: %1 us  Termios: %2 us")
+                              .arg(qtLatency < 0 ? tr("n/a") : QString::number(qtLatency))
+                              .arg(termiosLatency < 0 ? tr("n/a") : QString::number(termiosLatency)));
+}
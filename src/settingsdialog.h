@@ -32,6 +32,9 @@
 #include <QtSerialPort/QSerialPort>
 #include <QtSerialPort/QSerialPortInfo>
 #include <QLineEdit>
+#include <QApplication>
+#include <QSettings>
+#include <QIntValidator>
 
 #include "../ui/ui_settingsdialog.h"
 
@@ -44,28 +47,65 @@ class SettingsDialog : public QDialog
     Q_OBJECT
 
 public:
+    enum class transportType {
+        qtSerialPort,
+        nativeTermios,
+        pseudoTerminal,
+        localSocket,
+        tcpSocket,
+        sharedMemory
+    };
+
+    enum class pollMode {
+        eventLoop,
+        epoll,
+        busyPoll
+    };
+
+    // Link faults to inject (see FaultInjector); off unless requested on
+    // the command line
+    struct FaultSettings {
+        bool enabled;
+        quint32 seed;
+        int latencyMs;
+        int jitterMs;
+        double dropRate;
+        double corruptRate;
+        double splitRate;
+    };
+
     struct Settings {
         QString name;
-        QSerialPort::BaudRate baudRate;
+        transportType transport;
+        pollMode polling;
+        QString address;
+        qint32 baudRate;
         QSerialPort::DataBits dataBits;
         QSerialPort::Parity parity;
         QSerialPort::StopBits stopBits;
         QSerialPort::FlowControl flowControl;
+        FaultSettings faults;
     };
 
     explicit SettingsDialog(QWidget *parent = nullptr);
     ~SettingsDialog();
 
     Settings settings() const;
+    void setFaultSettings(const FaultSettings &faults);
 
 private slots:
     void on_pushButton_clicked();
+    void on_measureLatencyButton_clicked();
 
 private:
     Ui::SettingsDialog *ui;
     Settings currentSettings;
 
     void fillPortsInfo();
+    void fillTransportInfo();
+    void fillLineInfo();
+    void loadSettings();
+    void saveSettings();
     void updateSettings();
 };
 
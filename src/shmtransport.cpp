@@ -0,0 +1,216 @@
+/************************************************************************
+
+    shmtransport.cpp
+
+    Shared-memory transport functions
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#include "shmtransport.h"
+
+#ifdef Q_OS_LINUX
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+ShmTransport::ShmTransport(const SettingsDialog::Settings &settings, QObject *parent) :
+    Transport(parent),
+    settings(settings)
+{
+    channel = nullptr;
+    running = false;
+    notifyPending = false;
+}
+
+ShmTransport::~ShmTransport()
+{
+    close();
+}
+
+// Create the shared memory object and start waiting for the host
+bool ShmTransport::open(void)
+{
+    // POSIX shared memory names start with a single slash
+    shmName = settings.address.isEmpty() ? QString(VP415SHM_DEFAULT_NAME) : settings.address;
+    if (!shmName.startsWith('/')) shmName.prepend('/');
+
+    int fd = shm_open(shmName.toLocal8Bit().constData(), O_CREAT | O_RDWR, 0600);
+    if (fd < 0) {
+        lastError = shmName + ": " + QString::fromLocal8Bit(strerror(errno));
+        return false;
+    }
+
+    if (ftruncate(fd, sizeof(vp415shm_channel)) != 0) {
+        lastError = shmName + ": " + QString::fromLocal8Bit(strerror(errno));
+        ::close(fd);
+        return false;
+    }
+
+    void *mapping = mmap(nullptr, sizeof(vp415shm_channel), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        lastError = shmName + ": " + QString::fromLocal8Bit(strerror(errno));
+        return false;
+    }
+
+    // Always start from empty rings; a host that mapped a previous channel
+    // sees the reset through the shared counters
+    channel = static_cast<vp415shm_channel *>(mapping);
+    vp415shm_init(channel);
+
+    running = true;
+    readerThread = std::thread(&ShmTransport::readerLoop, this);
+
+    lastError.clear();
+    return true;
+}
+
+void ShmTransport::close(void)
+{
+    if (readerThread.joinable()) {
+        running = false;
+        vp415shm_wake(&channel->toPlayer);
+        readerThread.join();
+    }
+
+    if (channel) {
+        munmap(channel, sizeof(vp415shm_channel));
+        shm_unlink(shmName.toLocal8Bit().constData());
+        channel = nullptr;
+    }
+
+    Chunk discard;
+    while (receiveQueue.pop(discard)) {}
+}
+
+bool ShmTransport::isOpen(void) const
+{
+    return channel != nullptr;
+}
+
+QByteArray ShmTransport::readAll(void)
+{
+    qint64 arrivalNs;
+    return readStamped(arrivalNs);
+}
+
+QByteArray ShmTransport::readStamped(qint64 &arrivalNs)
+{
+    QByteArray data;
+    arrivalNs = 0;
+
+    notifyPending.store(false, std::memory_order_release);
+    Chunk chunk;
+    while (receiveQueue.pop(chunk)) {
+        if (data.isEmpty()) arrivalNs = chunk.arrivalNs;
+        data.append(chunk.data);
+    }
+
+    return data;
+}
+
+bool ShmTransport::hasReaderThread(void) const
+{
+    return true;
+}
+
+qint64 ShmTransport::write(const QByteArray &data)
+{
+    if (!channel) return -1;
+
+    // While the host's ring is full, poll it briefly and then back off to
+    // short sleeps.  If it stays full for a whole field the host has
+    // stopped reading; drop the remainder rather than stall the I/O thread.
+    const char *source = data.constData();
+    quint32 remaining = static_cast<quint32>(data.size());
+    quint32 spins = 0;
+    qint64 fullSinceNs = 0;
+
+    while (remaining > 0) {
+        quint32 written = vp415shm_write(&channel->toHost, source, remaining);
+        source += written;
+        remaining -= written;
+
+        if (written > 0) {
+            spins = 0;
+            fullSinceNs = 0;
+            continue;
+        }
+
+        if (spins < VP415SHM_SPIN_COUNT) {
+            spins++;
+            vp415shm_pause();
+            continue;
+        }
+
+        qint64 nowNs = MonotonicClock::nowNs();
+        if (fullSinceNs == 0) fullSinceNs = nowNs;
+        if (nowNs - fullSinceNs > hostStallNs) {
+            qDebug() << "ShmTransport::write(): Host ring full - dropped" << remaining << "bytes";
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    qint64 sent = data.size() - remaining;
+    if (sent > 0) emit bytesWritten(sent);
+    return sent;
+}
+
+QString ShmTransport::errorString(void) const
+{
+    return lastError;
+}
+
+QString ShmTransport::endpointName(void) const
+{
+    return shmName;
+}
+
+// Wait for data from the host (reader thread)
+void ShmTransport::readerLoop(void)
+{
+    char buffer[VP415SHM_RING_SIZE];
+
+    while (running.load(std::memory_order_acquire)) {
+        // Wake up periodically so a lost shutdown wake cannot hang close()
+        if (vp415shm_wait(&channel->toPlayer, 100000000u) == 0) continue;
+
+        quint32 length = vp415shm_read(&channel->toPlayer, buffer, sizeof(buffer));
+        if (length == 0) continue;
+
+        Chunk chunk;
+        chunk.arrivalNs = MonotonicClock::nowNs();
+        chunk.data = QByteArray(buffer, static_cast<int>(length));
+        while (!receiveQueue.push(chunk)) {
+            if (!running.load(std::memory_order_acquire)) return;
+            std::this_thread::yield();
+        }
+
+        if (!notifyPending.exchange(true, std::memory_order_acq_rel)) emit readyRead();
+    }
+}
+
+#endif // Q_OS_LINUX
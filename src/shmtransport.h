@@ -0,0 +1,96 @@
+/************************************************************************
+
+    shmtransport.h
+
+    Shared-memory transport function header
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#ifndef SHMTRANSPORT_H
+#define SHMTRANSPORT_H
+
+#include <QtGlobal>
+
+#ifdef Q_OS_LINUX
+
+#include <QDebug>
+
+#include <atomic>
+#include <thread>
+
+#include "transport.h"
+#include "spscqueue.h"
+#include "monotonicclock.h"
+#include "vp415shm.h"
+
+// Serves a co-located BBC Micro emulator through the shared-memory rings
+// described in vp415shm.h.  A reader thread waits on the host-to-player
+// ring and passes the data straight on towards the GUI thread (see
+// SerialIoWorker); responses are copied straight into the player-to-host
+// ring.
+class ShmTransport : public Transport
+{
+    Q_OBJECT
+
+public:
+    explicit ShmTransport(const SettingsDialog::Settings &settings, QObject *parent = nullptr);
+    ~ShmTransport();
+
+    bool open(void) override;
+    void close(void) override;
+    bool isOpen(void) const override;
+
+    QByteArray readAll(void) override;
+    QByteArray readStamped(qint64 &arrivalNs) override;
+    bool hasReaderThread(void) const override;
+    qint64 write(const QByteArray &data) override;
+
+    QString errorString(void) const override;
+    QString endpointName(void) const override;
+
+private:
+    SettingsDialog::Settings settings;
+    QString shmName;
+    QString lastError;
+    vp415shm_channel *channel;
+
+    // How long the host's ring may stay full before the rest of a
+    // response is dropped
+    static const qint64 hostStallNs = 20000000;
+
+    std::thread readerThread;
+    std::atomic<bool> running;
+    std::atomic<bool> notifyPending;
+
+    // Data taken from the ring, stamped as it was read
+    struct Chunk {
+        QByteArray data;
+        qint64 arrivalNs;
+    };
+    SpscQueue<Chunk, 256> receiveQueue;
+
+    void readerLoop(void);
+};
+
+#endif // Q_OS_LINUX
+
+#endif // SHMTRANSPORT_H
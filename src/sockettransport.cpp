@@ -0,0 +1,273 @@
+/************************************************************************
+
+    sockettransport.cpp
+
+    Stream socket transport functions
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#include "sockettransport.h"
+
+SocketTransport::SocketTransport(const SettingsDialog::Settings &settings, QObject *parent) :
+    Transport(parent),
+    settings(settings)
+{
+    localServer = nullptr;
+    tcpServer = nullptr;
+    client = nullptr;
+    flushScheduled = false;
+}
+
+SocketTransport::~SocketTransport()
+{
+    close();
+}
+
+// Start listening for a host
+bool SocketTransport::open(void)
+{
+    if (settings.transport == SettingsDialog::transportType::tcpSocket) {
+        // The address is either a port number, host:port or, for IPv6,
+        // [host]:port; only the loopback interface is used unless a host
+        // is given
+        QHostAddress address(QHostAddress::LocalHost);
+        QString host;
+        QString portString = settings.address;
+
+        if (portString.startsWith('[')) {
+            int bracket = portString.indexOf(']');
+            if (bracket < 0 || portString.mid(bracket + 1, 1) != ":") {
+                lastError = tr("Invalid TCP address (expected [address]:port): ") + settings.address;
+                return false;
+            }
+            host = portString.mid(1, bracket - 1);
+            portString = portString.mid(bracket + 2);
+        } else if (portString.count(':') > 1) {
+            // An IPv6 address has colons of its own, so the port cannot be
+            // told apart from the address without brackets
+            lastError = tr("IPv6 addresses must be given as [address]:port: ") + settings.address;
+            return false;
+        } else {
+            int separator = portString.indexOf(':');
+            if (separator >= 0) {
+                host = portString.left(separator);
+                portString = portString.mid(separator + 1);
+            }
+        }
+
+        if (!host.isEmpty()) {
+            address = QHostAddress(host);
+            if (address.isNull()) {
+                lastError = tr("Invalid TCP address: ") + settings.address;
+                return false;
+            }
+        }
+
+        bool ok = false;
+        quint16 port = portString.toUShort(&ok);
+        if (!ok) {
+            lastError = tr("Invalid TCP port: ") + settings.address;
+            return false;
+        }
+
+        tcpServer = new QTcpServer(this);
+        connect(tcpServer, &QTcpServer::newConnection, this, &SocketTransport::acceptConnection);
+        if (!tcpServer->listen(address, port)) {
+            lastError = tcpServer->errorString();
+            delete tcpServer;
+            tcpServer = nullptr;
+            return false;
+        }
+    } else {
+        localServer = new QLocalServer(this);
+        connect(localServer, &QLocalServer::newConnection, this, &SocketTransport::acceptConnection);
+        bool listening = localServer->listen(settings.address);
+        QString error;
+
+        // A socket left behind by a previous run that crashed is removed,
+        // but one that another emulator is still listening on is not
+        if (!listening && localServer->serverError() == QAbstractSocket::AddressInUseError) {
+            QLocalSocket probe;
+            probe.connectToServer(settings.address);
+            if (probe.waitForConnected(100)) {
+                probe.disconnectFromServer();
+                error = tr("Local socket is in use by another process: ") + settings.address;
+            } else {
+                qDebug() << "SocketTransport::open(): Removing stale local socket" << settings.address;
+                QLocalServer::removeServer(settings.address);
+                listening = localServer->listen(settings.address);
+            }
+        }
+
+        if (!listening) {
+            lastError = error.isEmpty() ? localServer->errorString() : error;
+            delete localServer;
+            localServer = nullptr;
+            return false;
+        }
+    }
+
+    lastError.clear();
+    return true;
+}
+
+void SocketTransport::close(void)
+{
+    discardWrites();
+
+    if (client) {
+        client->disconnect(this);
+        client->close();
+        client->deleteLater();
+        client = nullptr;
+    }
+
+    delete localServer;
+    localServer = nullptr;
+    delete tcpServer;
+    tcpServer = nullptr;
+}
+
+bool SocketTransport::isOpen(void) const
+{
+    return localServer != nullptr || tcpServer != nullptr;
+}
+
+QByteArray SocketTransport::readAll(void)
+{
+    if (!client) return QByteArray();
+    return client->readAll();
+}
+
+qint64 SocketTransport::write(const QByteArray &data)
+{
+    // Nobody is connected; the response is lost just as it would be on an
+    // unplugged serial cable, so none of it is accepted
+    if (!client) return 0;
+
+    writeBatch.append(data);
+
+    // Send everything written during this pass of the event loop in one go
+    if (!flushScheduled) {
+        flushScheduled = true;
+        QMetaObject::invokeMethod(this, "flushWrites", Qt::QueuedConnection);
+    }
+
+    return data.size();
+}
+
+QString SocketTransport::errorString(void) const
+{
+    return lastError;
+}
+
+QString SocketTransport::endpointName(void) const
+{
+    if (localServer) return localServer->fullServerName();
+    if (tcpServer) {
+        QHostAddress address = tcpServer->serverAddress();
+        QString host = address.toString();
+        if (address.protocol() == QAbstractSocket::IPv6Protocol) host = "[" + host + "]";
+        return host + ":" + QString::number(tcpServer->serverPort());
+    }
+    return settings.address;
+}
+
+// A host has connected
+void SocketTransport::acceptConnection(void)
+{
+    QIODevice *socket = nullptr;
+
+    if (localServer) socket = localServer->nextPendingConnection();
+    if (tcpServer) {
+        QTcpSocket *tcpSocket = tcpServer->nextPendingConnection();
+
+        // F-code responses are tiny; send them without waiting for Nagle
+        if (tcpSocket) tcpSocket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        socket = tcpSocket;
+    }
+
+    if (socket) attachClient(socket);
+}
+
+// Make the socket the current host connection
+void SocketTransport::attachClient(QIODevice *socket)
+{
+    if (client) {
+        qDebug() << "SocketTransport::attachClient(): New host connected - dropping the previous one";
+        discardWrites();
+        client->disconnect(this);
+        client->close();
+        client->deleteLater();
+    }
+
+    client = socket;
+
+    connect(client, &QIODevice::readyRead, this, &Transport::readyRead);
+    connect(client, &QIODevice::bytesWritten, this, &Transport::bytesWritten);
+    if (localServer) connect(static_cast<QLocalSocket *>(client), &QLocalSocket::disconnected, this, &SocketTransport::clientDisconnected);
+    if (tcpServer) connect(static_cast<QTcpSocket *>(client), &QTcpSocket::disconnected, this, &SocketTransport::clientDisconnected);
+
+    qDebug() << "SocketTransport::attachClient(): Host connected to" << endpointName();
+
+    // Pick up anything sent before the signals were connected
+    if (client->bytesAvailable() > 0) emit readyRead();
+}
+
+// The host has gone away; keep listening for the next one
+void SocketTransport::clientDisconnected(void)
+{
+    qDebug() << "SocketTransport::clientDisconnected(): Host disconnected from" << endpointName();
+
+    discardWrites();
+
+    if (client) {
+        client->deleteLater();
+        client = nullptr;
+    }
+}
+
+// Write out the batched data
+void SocketTransport::flushWrites(void)
+{
+    flushScheduled = false;
+
+    if (client && !writeBatch.isEmpty()) {
+        // Report anything the socket refuses as written (see discardWrites())
+        qint64 written = client->write(writeBatch);
+        if (written < 0) written = 0;
+        if (written < writeBatch.size()) emit bytesWritten(writeBatch.size() - written);
+    }
+    writeBatch.clear();
+}
+
+// Drop the batched data and anything the host connection has not sent yet.
+// It will never be reported as written, so report it here to keep the
+// writer's in-flight accounting balanced.
+void SocketTransport::discardWrites(void)
+{
+    qint64 dropped = writeBatch.size();
+    if (client) dropped += client->bytesToWrite();
+    writeBatch.clear();
+
+    if (dropped > 0) emit bytesWritten(dropped);
+}
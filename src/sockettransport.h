@@ -0,0 +1,82 @@
+/************************************************************************
+
+    sockettransport.h
+
+    Stream socket transport function header
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#ifndef SOCKETTRANSPORT_H
+#define SOCKETTRANSPORT_H
+
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QDebug>
+
+#include "transport.h"
+
+// Listens on a Unix-domain (local) or localhost TCP socket for a BBC Micro
+// emulator that speaks the BeebSCSI serial stream directly, avoiding a
+// virtual serial cable.  Only one host is served at a time; a new
+// connection replaces the previous one.
+class SocketTransport : public Transport
+{
+    Q_OBJECT
+
+public:
+    explicit SocketTransport(const SettingsDialog::Settings &settings, QObject *parent = nullptr);
+    ~SocketTransport();
+
+    bool open(void) override;
+    void close(void) override;
+    bool isOpen(void) const override;
+
+    QByteArray readAll(void) override;
+    qint64 write(const QByteArray &data) override;
+
+    QString errorString(void) const override;
+    QString endpointName(void) const override;
+
+private slots:
+    void acceptConnection(void);
+    void clientDisconnected(void);
+    void flushWrites(void);
+
+private:
+    SettingsDialog::Settings settings;
+    QLocalServer *localServer;
+    QTcpServer *tcpServer;
+    QIODevice *client;
+    QString lastError;
+
+    // Writes made during one pass of the event loop are sent together
+    QByteArray writeBatch;
+    bool flushScheduled;
+
+    void attachClient(QIODevice *socket);
+    void discardWrites(void);
+};
+
+#endif // SOCKETTRANSPORT_H
@@ -0,0 +1,97 @@
+/************************************************************************
+
+    spscqueue.h
+
+    Single-producer/single-consumer lock-free queue
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Fixed capacity ring buffer that can be written by exactly one thread
+// and read by exactly one other thread without locking.  The capacity
+// must be a power of two.
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscQueue capacity must be a power of two");
+
+public:
+    SpscQueue() : head(0), tail(0) {}
+
+    // Producer side: returns false if the queue is full
+    bool push(T item)
+    {
+        const size_t currentHead = head.load(std::memory_order_relaxed);
+        if (currentHead - tail.load(std::memory_order_acquire) == Capacity) return false;
+
+        buffer[currentHead & (Capacity - 1)] = std::move(item);
+        head.store(currentHead + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side: returns false if the queue is empty
+    bool pop(T &item)
+    {
+        const size_t currentTail = tail.load(std::memory_order_relaxed);
+        if (currentTail == head.load(std::memory_order_acquire)) return false;
+
+        item = std::move(buffer[currentTail & (Capacity - 1)]);
+        buffer[currentTail & (Capacity - 1)] = T();
+        tail.store(currentTail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate number of queued items (exact when called from either end)
+    size_t size() const
+    {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    bool isEmpty() const
+    {
+        return size() == 0;
+    }
+
+    size_t capacity() const
+    {
+        return Capacity;
+    }
+
+private:
+    // The producer and consumer indexes are kept on separate cache lines
+    // so the two threads do not fight over the same line
+    std::atomic<size_t> head;
+    char headPadding[64 - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> tail;
+    char tailPadding[64 - sizeof(std::atomic<size_t>)];
+
+    T buffer[Capacity];
+};
+
+#endif // SPSCQUEUE_H
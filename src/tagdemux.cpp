@@ -0,0 +1,218 @@
+/************************************************************************
+
+    tagdemux.cpp
+
+    BeebSCSI serial stream tag demultiplexer
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#include "tagdemux.h"
+
+#include <cstring>
+
+TagDemux::TagDemux()
+{
+    tagCount = 0;
+    resetCounters();
+    reset();
+}
+
+bool TagDemux::addTag(const char *tagName, Handler handler)
+{
+    size_t length = strlen(tagName);
+    if (length == 0 || length > maximumNameLength || tagCount == maximumTags) return false;
+
+    memcpy(tags[tagCount].name, tagName, length + 1);
+    tags[tagCount].nameLength = length;
+    tags[tagCount].handler = handler;
+    tagCount++;
+    return true;
+}
+
+void TagDemux::reset(void)
+{
+    state = parserState::text;
+    currentTag = -1;
+    nameLength = 0;
+    payloadLength = 0;
+}
+
+uint64_t TagDemux::malformedTags(void) const
+{
+    return malformedCount;
+}
+
+uint64_t TagDemux::discardedBytes(void) const
+{
+    return discardedCount;
+}
+
+void TagDemux::resetCounters(void)
+{
+    malformedCount = 0;
+    discardedCount = 0;
+}
+
+void TagDemux::putData(const char *data, size_t length)
+{
+    size_t i = 0;
+
+    while (i < length) {
+        // Most of the stream is debug text, so runs of text and payload are
+        // skipped with memchr() (which is vectorised by the C library) and
+        // only the bytes in and around tag names go through the state machine
+        if (state == parserState::text) {
+            const char *next = static_cast<const char *>(memchr(data + i, '<', length - i));
+            if (!next) return;
+
+            i = static_cast<size_t>(next - data) + 1;
+            nameLength = 0;
+            state = parserState::openTag;
+            continue;
+        }
+
+        if (state == parserState::payload) {
+            const char *next = static_cast<const char *>(memchr(data + i, '<', length - i));
+            size_t run = next ? static_cast<size_t>(next - data) - i : length - i;
+
+            appendPayload(data + i, run);
+            i += run;
+
+            // The payload may have been abandoned as too long, in which case
+            // the '<' is handled as text
+            if (next && state == parserState::payload) {
+                nameLength = 0;
+                state = parserState::closeTag;
+                i++;
+            }
+            continue;
+        }
+
+        const char byte = data[i++];
+
+        switch (state) {
+            case parserState::text:
+            case parserState::payload:
+            // Handled above
+            break;
+
+            case parserState::openTag:
+            if (byte == '>') {
+                // Only registered tags start a payload; anything else is
+                // debug text
+                currentTag = findTag(name, nameLength);
+                payloadLength = 0;
+                state = (currentTag >= 0) ? parserState::payload : parserState::text;
+            } else if (byte == '<') {
+                nameLength = 0;
+            } else if (nameLength < maximumNameLength) {
+                name[nameLength++] = byte;
+            } else {
+                state = parserState::text;
+            }
+            break;
+
+            case parserState::closeTag:
+            if (byte == '>') {
+                const Tag &tag = tags[currentTag];
+                int openTag = findTag(name, nameLength);
+
+                if (nameLength == tag.nameLength + 1 && name[0] == '/' &&
+                        memcmp(name + 1, tag.name, tag.nameLength) == 0) {
+                    // Matching close tag
+                    dispatch();
+                    state = parserState::text;
+                } else if (openTag >= 0) {
+                    // A new message started before this one was closed;
+                    // drop the unterminated message and follow the new one
+                    discardPayload(0);
+                    currentTag = openTag;
+                    state = parserState::payload;
+                } else {
+                    // Not a tag after all - keep the text as payload
+                    state = parserState::payload;
+                    appendPayload("<", 1);
+                    appendPayload(name, nameLength);
+                    appendPayload(">", 1);
+                }
+            } else if (byte == '<') {
+                appendPayload("<", 1);
+                appendPayload(name, nameLength);
+                nameLength = 0;
+            } else if (nameLength < maximumNameLength) {
+                name[nameLength++] = byte;
+            } else {
+                state = parserState::payload;
+                appendPayload("<", 1);
+                appendPayload(name, nameLength);
+                appendPayload(&byte, 1);
+            }
+            break;
+        }
+    }
+}
+
+// Return the index of a registered tag, or -1
+int TagDemux::findTag(const char *tagName, size_t length) const
+{
+    for (size_t i = 0; i < tagCount; i++) {
+        if (tags[i].nameLength == length && memcmp(tags[i].name, tagName, length) == 0) return static_cast<int>(i);
+    }
+
+    return -1;
+}
+
+// Add bytes to the payload; a message too long for the buffer is abandoned
+void TagDemux::appendPayload(const char *data, size_t length)
+{
+    if (state == parserState::text) return;
+
+    if (payloadLength + length > maximumPayloadLength) {
+        discardPayload(length);
+        state = parserState::text;
+        return;
+    }
+
+    memcpy(payloadBuffer + payloadLength, data, length);
+    payloadLength += length;
+}
+
+// Drop the current payload (and extraBytes that would have followed it)
+void TagDemux::discardPayload(size_t extraBytes)
+{
+    malformedCount++;
+    discardedCount += payloadLength + extraBytes;
+    payloadLength = 0;
+}
+
+// Pass a complete payload (without surrounding white space) to its handler
+void TagDemux::dispatch(void)
+{
+    const char *start = payloadBuffer;
+    const char *end = payloadBuffer + payloadLength;
+
+    while (start < end && (*start == ' ' || *start == '\t' || *start == '\r' || *start == '\n')) start++;
+    while (end > start && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n')) end--;
+
+    const Handler &handler = tags[currentTag].handler;
+    if (handler) handler(start, static_cast<size_t>(end - start));
+}
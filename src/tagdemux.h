@@ -0,0 +1,110 @@
+/************************************************************************
+
+    tagdemux.h
+
+    BeebSCSI serial stream tag demultiplexer header
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#ifndef TAGDEMUX_H
+#define TAGDEMUX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+// Splits the BeebSCSI serial stream into tagged messages such as
+// <FCODE>...</FCODE> and <UCD>...</UCD>.  An incremental state machine
+// handles the tags, so a tag may be split across any number of reads, and
+// several messages may arrive in one read; text between tags is skipped a
+// block at a time.  All
+// buffers are fixed size; handlers receive a pointer into the shared
+// payload buffer, trimmed of surrounding white space, which is only valid
+// for the duration of the call.  A message longer than the payload buffer
+// is dropped and the parser resynchronises on the next '<', so memory use
+// stays fixed however noisy the line is.
+//
+// This class has no Qt dependency so that the parser can be built and
+// exercised on its own.
+class TagDemux
+{
+public:
+    typedef std::function<void(const char *payload, size_t length)> Handler;
+
+    static const size_t maximumTags = 8;
+    static const size_t maximumNameLength = 15;
+    static const size_t maximumPayloadLength = 256;
+
+    TagDemux();
+
+    // Register a handler for <name>...</name>; returns false if the name is
+    // too long or there are no free tag slots
+    bool addTag(const char *name, Handler handler);
+
+    // Feed received bytes through the state machine
+    void putData(const char *data, size_t length);
+
+    // Forget any partially received tag
+    void reset(void);
+
+    // Messages abandoned because they were too long or were not closed
+    // before the next message started, and the payload bytes lost with them
+    uint64_t malformedTags(void) const;
+    uint64_t discardedBytes(void) const;
+    void resetCounters(void);
+
+private:
+    enum class parserState {
+        text,           // Outside any tag, waiting for '<'
+        openTag,        // Reading a tag name after '<'
+        payload,        // Inside a recognised tag
+        closeTag        // Reading a tag name after '<' inside a payload
+    };
+
+    struct Tag {
+        char name[maximumNameLength + 1];
+        size_t nameLength;
+        Handler handler;
+    };
+
+    Tag tags[maximumTags];
+    size_t tagCount;
+
+    parserState state;
+    int currentTag;
+
+    char name[maximumNameLength + 1];
+    size_t nameLength;
+
+    char payloadBuffer[maximumPayloadLength];
+    size_t payloadLength;
+
+    uint64_t malformedCount;
+    uint64_t discardedCount;
+
+    int findTag(const char *tagName, size_t length) const;
+    void appendPayload(const char *data, size_t length);
+    void discardPayload(size_t extraBytes);
+    void dispatch(void);
+};
+
+#endif // TAGDEMUX_H
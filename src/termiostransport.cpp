@@ -0,0 +1,414 @@
+/************************************************************************
+
+    termiostransport.cpp
+
+    Native termios serial transport functions
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#include "termiostransport.h"
+
+#ifdef Q_OS_LINUX
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/ioctl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <linux/serial.h>
+
+// Map a baud rate to the termios speed constant
+static speed_t baudToSpeed(qint32 baudRate)
+{
+    switch (baudRate) {
+        case 1200: return B1200;
+        case 2400: return B2400;
+        case 4800: return B4800;
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+        case 460800: return B460800;
+        case 500000: return B500000;
+        case 576000: return B576000;
+        case 921600: return B921600;
+        case 1000000: return B1000000;
+        case 1500000: return B1500000;
+        case 2000000: return B2000000;
+        case 3000000: return B3000000;
+        case 4000000: return B4000000;
+        default: return B0;
+    }
+}
+
+TermiosTransport::TermiosTransport(const SettingsDialog::Settings &settings, QObject *parent) :
+    Transport(parent),
+    settings(settings)
+{
+    fd = -1;
+    epollFd = -1;
+    wakeFd = -1;
+    readNotifier = nullptr;
+    writeNotifier = nullptr;
+    running = false;
+    notifyPending = false;
+    bufferArrivalNs = 0;
+}
+
+TermiosTransport::~TermiosTransport()
+{
+    close();
+}
+
+// Open the tty named in the settings
+bool TermiosTransport::open(void)
+{
+    // Accept either a port name (ttyUSB0) or a full device path
+    devicePath = settings.name;
+    if (!devicePath.startsWith('/')) devicePath = QString("/dev/") + devicePath;
+
+    int descriptor = ::open(devicePath.toLocal8Bit().constData(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (descriptor < 0) {
+        lastError = devicePath + ": " + QString::fromLocal8Bit(strerror(errno));
+        return false;
+    }
+
+    fd = descriptor;
+    if (!configureLine()) {
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    setLowLatency();
+
+    return attach(fd);
+}
+
+// Start reading from an open file descriptor
+bool TermiosTransport::attach(int descriptor)
+{
+    fd = descriptor;
+
+    // Writes that would block are finished when the tty signals it can take more
+    writeNotifier = new QSocketNotifier(fd, QSocketNotifier::Write, this);
+    writeNotifier->setEnabled(false);
+    connect(writeNotifier, SIGNAL(activated(int)), this, SLOT(writeNotified()));
+
+    if (settings.polling == SettingsDialog::pollMode::eventLoop) {
+        // Reads are driven by the I/O thread's event loop
+        readNotifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+        connect(readNotifier, SIGNAL(activated(int)), this, SLOT(readNotified()));
+    } else {
+        // Reads are driven by a dedicated thread; the eventfd is used to
+        // wake it when the transport is closed
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (wakeFd < 0 || epollFd < 0) {
+            lastError = QString("epoll: ") + QString::fromLocal8Bit(strerror(errno));
+            close();
+            return false;
+        }
+
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+        event.data.fd = wakeFd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+
+        running = true;
+        pollThread = std::thread(&TermiosTransport::pollLoop, this);
+    }
+
+    lastError.clear();
+    return true;
+}
+
+void TermiosTransport::close(void)
+{
+    // Stop the poll thread
+    if (pollThread.joinable()) {
+        running = false;
+        quint64 wake = 1;
+        if (::write(wakeFd, &wake, sizeof(wake)) < 0) qDebug() << "TermiosTransport::close(): Could not wake poll thread";
+        pollThread.join();
+    }
+
+    delete readNotifier;
+    readNotifier = nullptr;
+    delete writeNotifier;
+    writeNotifier = nullptr;
+
+    if (epollFd >= 0) ::close(epollFd);
+    if (wakeFd >= 0) ::close(wakeFd);
+    if (fd >= 0) ::close(fd);
+    epollFd = -1;
+    wakeFd = -1;
+    fd = -1;
+
+    // Data still waiting for the tty will never be sent; report it as
+    // written to keep the writer's in-flight accounting balanced
+    if (!pendingWrite.isEmpty()) emit bytesWritten(pendingWrite.size());
+    pendingWrite.clear();
+    receiveBuffer.clear();
+    Chunk discard;
+    while (receiveQueue.pop(discard)) {}
+}
+
+bool TermiosTransport::isOpen(void) const
+{
+    return fd >= 0;
+}
+
+QByteArray TermiosTransport::readAll(void)
+{
+    qint64 arrivalNs;
+    return readStamped(arrivalNs);
+}
+
+QByteArray TermiosTransport::readStamped(qint64 &arrivalNs)
+{
+    QByteArray data;
+    data.swap(receiveBuffer);
+    arrivalNs = bufferArrivalNs;
+
+    // Collect anything delivered by the poll thread
+    notifyPending.store(false, std::memory_order_release);
+    Chunk chunk;
+    while (receiveQueue.pop(chunk)) {
+        if (data.isEmpty()) arrivalNs = chunk.arrivalNs;
+        data.append(chunk.data);
+    }
+
+    return data;
+}
+
+bool TermiosTransport::hasReaderThread(void) const
+{
+    return settings.polling != SettingsDialog::pollMode::eventLoop;
+}
+
+qint64 TermiosTransport::write(const QByteArray &data)
+{
+    if (fd < 0) return -1;
+
+    // Keep ordering behind anything that is still waiting to go out
+    if (!pendingWrite.isEmpty()) {
+        pendingWrite.append(data);
+        return data.size();
+    }
+
+    ssize_t written = ::write(fd, data.constData(), data.size());
+    if (written < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            lastError = QString::fromLocal8Bit(strerror(errno));
+            return -1;
+        }
+        written = 0;
+    }
+
+    if (written > 0) emit bytesWritten(written);
+
+    // Hold the remainder until the tty can accept it
+    if (written < data.size()) {
+        pendingWrite = data.mid(written);
+        writeNotifier->setEnabled(true);
+    }
+
+    return data.size();
+}
+
+QString TermiosTransport::errorString(void) const
+{
+    return lastError;
+}
+
+QString TermiosTransport::endpointName(void) const
+{
+    return devicePath;
+}
+
+// Put the line into raw mode with the configured speed and framing
+bool TermiosTransport::configureLine(void)
+{
+    struct termios tio;
+
+    if (tcgetattr(fd, &tio) != 0) {
+        lastError = QString("tcgetattr: ") + QString::fromLocal8Bit(strerror(errno));
+        return false;
+    }
+
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+
+    tio.c_cflag &= ~CSIZE;
+    switch (settings.dataBits) {
+        case QSerialPort::Data5: tio.c_cflag |= CS5; break;
+        case QSerialPort::Data6: tio.c_cflag |= CS6; break;
+        case QSerialPort::Data7: tio.c_cflag |= CS7; break;
+        default: tio.c_cflag |= CS8; break;
+    }
+
+    tio.c_cflag &= ~(PARENB | PARODD);
+    if (settings.parity == QSerialPort::EvenParity) tio.c_cflag |= PARENB;
+    if (settings.parity == QSerialPort::OddParity) tio.c_cflag |= PARENB | PARODD;
+
+    if (settings.stopBits == QSerialPort::TwoStop) tio.c_cflag |= CSTOPB;
+    else tio.c_cflag &= ~CSTOPB;
+
+    if (settings.flowControl == QSerialPort::HardwareControl) tio.c_cflag |= CRTSCTS;
+    else tio.c_cflag &= ~CRTSCTS;
+
+    // read() returns immediately with whatever has arrived; waiting is done
+    // by the notifier or poll thread rather than the line discipline, so no
+    // inter-character timer delays delivery of a short F-code
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+
+    speed_t speed = baudToSpeed(settings.baudRate);
+    if (speed == B0) {
+        lastError = QString("Unsupported baud rate %1").arg(settings.baudRate);
+        return false;
+    }
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+
+    if (tcsetattr(fd, TCSANOW, &tio) != 0) {
+        lastError = QString("tcsetattr: ") + QString::fromLocal8Bit(strerror(errno));
+        return false;
+    }
+
+    tcflush(fd, TCIOFLUSH);
+    return true;
+}
+
+// Ask the UART driver to push received bytes to the tty layer immediately
+// rather than batching them (not all drivers support this)
+void TermiosTransport::setLowLatency(void)
+{
+    struct serial_struct serialInfo;
+
+    if (ioctl(fd, TIOCGSERIAL, &serialInfo) != 0) {
+        qDebug() << "TermiosTransport::setLowLatency(): ASYNC_LOW_LATENCY not supported by this device";
+        return;
+    }
+
+    serialInfo.flags |= ASYNC_LOW_LATENCY;
+    if (ioctl(fd, TIOCSSERIAL, &serialInfo) != 0) {
+        qDebug() << "TermiosTransport::setLowLatency(): Could not set ASYNC_LOW_LATENCY";
+    }
+}
+
+// The tty has data to read (event loop mode)
+void TermiosTransport::readNotified(void)
+{
+    char buffer[4096];
+    ssize_t length;
+
+    while ((length = ::read(fd, buffer, sizeof(buffer))) > 0) {
+        if (receiveBuffer.isEmpty()) bufferArrivalNs = MonotonicClock::nowNs();
+        receiveBuffer.append(buffer, length);
+    }
+
+    if (length < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+        readNotifier->setEnabled(false);
+        emit fatalError(QString::fromLocal8Bit(strerror(errno)));
+    }
+
+    if (!receiveBuffer.isEmpty()) emit readyRead();
+}
+
+// The tty can accept more data
+void TermiosTransport::writeNotified(void)
+{
+    ssize_t written = ::write(fd, pendingWrite.constData(), pendingWrite.size());
+
+    if (written < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+        writeNotifier->setEnabled(false);
+        emit fatalError(QString::fromLocal8Bit(strerror(errno)));
+        return;
+    }
+
+    pendingWrite.remove(0, written);
+    if (pendingWrite.isEmpty()) writeNotifier->setEnabled(false);
+    if (written > 0) emit bytesWritten(written);
+}
+
+// Dedicated read loop (epoll and busy-poll modes)
+void TermiosTransport::pollLoop(void)
+{
+    const bool busyPoll = (settings.polling == SettingsDialog::pollMode::busyPoll);
+    char buffer[4096];
+    struct epoll_event event;
+
+    while (running.load(std::memory_order_acquire)) {
+        // In busy-poll mode the tty is checked continuously; otherwise the
+        // thread sleeps in epoll until data arrives or it is woken to stop
+        if (!busyPoll) {
+            int ready = epoll_wait(epollFd, &event, 1, -1);
+            if (ready <= 0) continue;
+            if (event.data.fd == wakeFd) break;
+        }
+
+        ssize_t length = ::read(fd, buffer, sizeof(buffer));
+        if (length > 0) {
+            deliver(buffer, length);
+        } else if (length < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            emit fatalError(QString::fromLocal8Bit(strerror(errno)));
+            break;
+        } else if (!busyPoll && (length == 0 || (event.events & (EPOLLHUP | EPOLLERR)))) {
+            // The tty was reported ready but has nothing left to read, so
+            // the line has hung up.  It would stay ready forever, so stop
+            // watching it rather than spin.  (A busy poll reads 0 whenever
+            // the line is quiet, as VMIN and VTIME are 0.)
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+            emit fatalError(QString("Serial line hung up"));
+            break;
+        }
+    }
+}
+
+// Pass data from the poll thread to the I/O thread, stamped here so that
+// the hop to the I/O thread counts towards the response latency
+void TermiosTransport::deliver(const char *data, qint64 length)
+{
+    Chunk chunk;
+    chunk.arrivalNs = MonotonicClock::nowNs();
+    chunk.data = QByteArray(data, static_cast<int>(length));
+
+    // If the I/O thread is far behind, wait for it rather than drop data
+    while (!receiveQueue.push(chunk)) {
+        if (!running.load(std::memory_order_acquire)) return;
+        std::this_thread::yield();
+    }
+
+    if (!notifyPending.exchange(true, std::memory_order_acq_rel)) emit readyRead();
+}
+
+#endif // Q_OS_LINUX
@@ -0,0 +1,110 @@
+/************************************************************************
+
+    termiostransport.h
+
+    Native termios serial transport function header
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#ifndef TERMIOSTRANSPORT_H
+#define TERMIOSTRANSPORT_H
+
+#include <QtGlobal>
+
+#ifdef Q_OS_LINUX
+
+#include <QSocketNotifier>
+#include <QDebug>
+
+#include <atomic>
+#include <thread>
+
+#include "transport.h"
+#include "spscqueue.h"
+#include "monotonicclock.h"
+
+// Low-latency serial transport that drives the tty directly rather than
+// through QSerialPort.  Reads either follow the I/O thread's event loop or
+// run on a dedicated epoll/busy-poll thread.
+class TermiosTransport : public Transport
+{
+    Q_OBJECT
+
+public:
+    explicit TermiosTransport(const SettingsDialog::Settings &settings, QObject *parent = nullptr);
+    ~TermiosTransport();
+
+    bool open(void) override;
+    void close(void) override;
+    bool isOpen(void) const override;
+
+    QByteArray readAll(void) override;
+    QByteArray readStamped(qint64 &arrivalNs) override;
+    bool hasReaderThread(void) const override;
+    qint64 write(const QByteArray &data) override;
+
+    QString errorString(void) const override;
+    QString endpointName(void) const override;
+
+protected:
+    // Used by transports that supply an already open file descriptor
+    bool attach(int descriptor);
+    QString lastError;
+
+private slots:
+    void readNotified(void);
+    void writeNotified(void);
+
+private:
+    SettingsDialog::Settings settings;
+    QString devicePath;
+    int fd;
+
+    QSocketNotifier *readNotifier;
+    QSocketNotifier *writeNotifier;
+    QByteArray pendingWrite;
+    QByteArray receiveBuffer;
+    qint64 bufferArrivalNs;
+
+    // Dedicated poll thread (epoll and busy-poll modes)
+    std::thread pollThread;
+    std::atomic<bool> running;
+    std::atomic<bool> notifyPending;
+    int epollFd;
+    int wakeFd;
+
+    // Data read by the poll thread, stamped as it was read
+    struct Chunk {
+        QByteArray data;
+        qint64 arrivalNs;
+    };
+    SpscQueue<Chunk, 256> receiveQueue;
+
+    bool configureLine(void);
+    void setLowLatency(void);
+    void pollLoop(void);
+    void deliver(const char *data, qint64 length);
+};
+
+#endif // Q_OS_LINUX
+
+#endif // TERMIOSTRANSPORT_H
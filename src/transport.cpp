@@ -0,0 +1,91 @@
+/************************************************************************
+
+    transport.cpp
+
+    Serial transport functions
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#include "transport.h"
+#include "qtserialtransport.h"
+#include "termiostransport.h"
+#include "ptytransport.h"
+#include "sockettransport.h"
+#include "shmtransport.h"
+#include "faultinjector.h"
+#include "monotonicclock.h"
+
+Transport::Transport(QObject *parent) : QObject(parent)
+{
+}
+
+Transport::~Transport()
+{
+}
+
+QByteArray Transport::readStamped(qint64 &arrivalNs)
+{
+    arrivalNs = MonotonicClock::nowNs();
+    return readAll();
+}
+
+bool Transport::hasReaderThread(void) const
+{
+    return false;
+}
+
+// Create the transport selected by the settings
+Transport *Transport::create(const SettingsDialog::Settings &settings, QObject *parent)
+{
+    Transport *transport;
+
+    switch (settings.transport) {
+#ifdef Q_OS_LINUX
+        case SettingsDialog::transportType::nativeTermios:
+        transport = new TermiosTransport(settings, parent);
+        break;
+
+        case SettingsDialog::transportType::pseudoTerminal:
+        transport = new PtyTransport(settings, parent);
+        break;
+
+        case SettingsDialog::transportType::sharedMemory:
+        transport = new ShmTransport(settings, parent);
+        break;
+#endif
+
+        case SettingsDialog::transportType::localSocket:
+        case SettingsDialog::transportType::tcpSocket:
+        transport = new SocketTransport(settings, parent);
+        break;
+
+        default:
+        transport = new QtSerialTransport(settings, parent);
+        break;
+    }
+
+    // The fault injector is only inserted when it is wanted, so a normal
+    // link pays nothing for it
+    if (settings.faults.enabled) transport = new FaultInjector(transport, settings.faults, parent);
+
+    return transport;
+}
@@ -0,0 +1,78 @@
+/************************************************************************
+
+    transport.h
+
+    Serial transport function header
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+
+#include "settingsdialog.h"
+
+// A transport carries the BeebSCSI byte stream to and from the emulator.
+// Transports are created and used from the serial I/O thread.
+class Transport : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit Transport(QObject *parent = nullptr);
+    virtual ~Transport();
+
+    virtual bool open(void) = 0;
+    virtual void close(void) = 0;
+    virtual bool isOpen(void) const = 0;
+
+    virtual QByteArray readAll(void) = 0;
+    virtual qint64 write(const QByteArray &data) = 0;
+
+    // Read everything received, with the monotonic time at which the oldest
+    // of it was read from the device.  Transports that read on their own
+    // thread stamp the data there; by default it is stamped on return.
+    virtual QByteArray readStamped(qint64 &arrivalNs);
+
+    // True if readyRead() is emitted from the transport's own reader
+    // thread, which may then call readAll() itself rather than hand the
+    // data on to the I/O thread's event loop
+    virtual bool hasReaderThread(void) const;
+
+    virtual QString errorString(void) const = 0;
+
+    // Where the host should connect (port name, device path, socket...)
+    virtual QString endpointName(void) const = 0;
+
+    // Create the transport selected by the settings
+    static Transport *create(const SettingsDialog::Settings &settings, QObject *parent = nullptr);
+
+signals:
+    void readyRead(void);
+    void bytesWritten(qint64 bytes);
+    void fatalError(QString error);
+};
+
+#endif // TRANSPORT_H
@@ -0,0 +1,115 @@
+/************************************************************************
+
+    virtualframesource.cpp
+
+    Virtual (headless) frame source functions
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#include "virtualframesource.h"
+
+VirtualFrameSource::VirtualFrameSource()
+{
+    baseFrame = 1;
+    playing = false;
+    stopFrame = 0;
+    clock = nullptr;
+    playStartField = 0;
+}
+
+void VirtualFrameSource::setClock(EmulationClock *emulationClock)
+{
+    clock = emulationClock;
+}
+
+// Remember the disc image (the video is never decoded)
+void VirtualFrameSource::loadDiscImage(QString fileName)
+{
+    discImage = fileName;
+    baseFrame = 1;
+    playing = false;
+}
+
+// Move to a specified frame number
+void VirtualFrameSource::setFrame(qint64 frameNumber)
+{
+    baseFrame = frameNumber;
+    if (playing) startPlayClock();
+}
+
+// Get the current frame number (PAL is 25 frames per second, so one frame
+// every 40 ms while playing)
+qint64 VirtualFrameSource::getFrame()
+{
+    if (!playing) return baseFrame;
+
+    qint64 frame = baseFrame + playedFrames();
+    if (stopFrame > 0 && baseFrame <= stopFrame && frame > stopFrame) frame = stopFrame;
+    return frame;
+}
+
+// Play from the current frame
+void VirtualFrameSource::play()
+{
+    if (playing) return;
+
+    startPlayClock();
+    playing = true;
+}
+
+// Pause on the current frame
+void VirtualFrameSource::pause()
+{
+    baseFrame = getFrame();
+    playing = false;
+}
+
+bool VirtualFrameSource::isPlaying()
+{
+    return playing;
+}
+
+qint64 VirtualFrameSource::fieldsIntoFrame()
+{
+    if (!playing) return 0;
+    if (clock) return (clock->currentField() - playStartField) % 2;
+    return (playClock.elapsed() % 40) / 20;
+}
+
+void VirtualFrameSource::startPlayClock(void)
+{
+    if (clock) playStartField = clock->currentField();
+    else playClock.start();
+}
+
+// Frames played since the play clock was started (two fields per frame)
+qint64 VirtualFrameSource::playedFrames(void)
+{
+    if (clock) return (clock->currentField() - playStartField) / 2;
+    return playClock.elapsed() / 40;
+}
+
+// Hold playback on a frame (a frame that has already been passed is ignored)
+void VirtualFrameSource::setStopFrame(qint64 frameNumber)
+{
+    stopFrame = (frameNumber > 0 && getFrame() <= frameNumber) ? frameNumber : 0;
+}
@@ -0,0 +1,69 @@
+/************************************************************************
+
+    virtualframesource.h
+
+    Virtual (headless) frame source function header
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+#ifndef VIRTUALFRAMESOURCE_H
+#define VIRTUALFRAMESOURCE_H
+
+#include <QElapsedTimer>
+#include <QDebug>
+
+#include "framesource.h"
+#include "emulationclock.h"
+
+// A frame source that advances at the PAL frame rate while playing but
+// never decodes the disc image.  Given an emulation clock it counts fields
+// rather than wall-clock time, so it also follows virtual time.
+class VirtualFrameSource : public FrameSource
+{
+public:
+    VirtualFrameSource();
+
+    void setClock(EmulationClock *emulationClock);
+
+    void loadDiscImage(QString fileName) override;
+    void setFrame(qint64 frameNumber) override;
+    qint64 getFrame() override;
+    void play() override;
+    void pause() override;
+    bool isPlaying() override;
+    qint64 fieldsIntoFrame() override;
+    void setStopFrame(qint64 frameNumber) override;
+
+private:
+    QString discImage;
+    qint64 baseFrame;
+    QElapsedTimer playClock;
+    EmulationClock *clock;
+    qint64 playStartField;
+    bool playing;
+    qint64 stopFrame;
+
+    void startPlayClock(void);
+    qint64 playedFrames(void);
+};
+
+#endif // VIRTUALFRAMESOURCE_H
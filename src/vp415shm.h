@@ -0,0 +1,219 @@
+/************************************************************************
+
+    vp415shm.h
+
+    Shared-memory F-code channel (embeddable C header)
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+/*
+    This header is self-contained C (also valid C++) so that BBC Micro
+    emulators running on the same Linux host can copy it into their own
+    source tree and talk to VP415Emu without a serial port or socket.
+
+    VP415Emu creates a POSIX shared memory object (default "/vp415emu")
+    containing one vp415shm_channel.  The channel holds two single-producer
+    single-consumer byte rings:
+
+        toPlayer - written by the host, read by VP415Emu.  Carries exactly
+                   the same byte stream BeebSCSI sends over its serial port
+                   (debug text, <FCODE>...</FCODE> and <UCD>...</UCD> tags).
+        toHost   - written by VP415Emu, read by the host.  Carries the F-code
+                   responses, each terminated by a carriage return.
+
+    A host maps the object and then uses vp415shm_write() on toPlayer and
+    vp415shm_read()/vp415shm_wait() on toHost.  Writers only make a futex
+    system call when the reader is actually asleep, so a busy link costs
+    no system calls at all.
+*/
+
+#ifndef VP415SHM_H
+#define VP415SHM_H
+
+/* Strict ISO C modes (-std=c99) hide struct timespec; ask for POSIX.  This
+   only takes effect if the header is included before any system header,
+   otherwise build with -std=gnu99 or define _POSIX_C_SOURCE yourself. */
+#if !defined(__cplusplus) && defined(__STRICT_ANSI__) && !defined(_POSIX_C_SOURCE) && !defined(_GNU_SOURCE) && !defined(_DEFAULT_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Strict ISO C modes hide the syscall() prototype */
+#if !defined(__cplusplus) && defined(__STRICT_ANSI__) && !defined(_GNU_SOURCE) && !defined(_DEFAULT_SOURCE)
+long syscall(long number, ...);
+#endif
+
+#define VP415SHM_MAGIC      0x35313450u /* "P415" */
+#define VP415SHM_VERSION    1u
+#define VP415SHM_RING_SIZE  4096u       /* must be a power of two */
+#define VP415SHM_SPIN_COUNT 2000u       /* polls before sleeping in the kernel */
+#define VP415SHM_DEFAULT_NAME "/vp415emu"
+
+typedef struct vp415shm_ring {
+    uint32_t head;                      /* next byte to write (producer) */
+    uint32_t waiting;                   /* non-zero while the consumer sleeps */
+    uint8_t producerPad[56];
+    uint32_t tail;                      /* next byte to read (consumer) */
+    uint8_t consumerPad[60];
+    uint8_t data[VP415SHM_RING_SIZE];
+} vp415shm_ring;
+
+typedef struct vp415shm_channel {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t ringSize;
+    uint32_t reserved;
+    uint8_t headerPad[48];
+    vp415shm_ring toPlayer;
+    vp415shm_ring toHost;
+} vp415shm_channel;
+
+/* Prepare a newly created channel (done by VP415Emu) */
+static inline void vp415shm_init(vp415shm_channel *channel)
+{
+    memset(channel, 0, sizeof(*channel));
+    channel->version = VP415SHM_VERSION;
+    channel->ringSize = VP415SHM_RING_SIZE;
+    __atomic_store_n(&channel->magic, VP415SHM_MAGIC, __ATOMIC_RELEASE);
+}
+
+/* Returns non-zero if the mapped memory holds a compatible channel */
+static inline int vp415shm_valid(const vp415shm_channel *channel)
+{
+    return __atomic_load_n(&channel->magic, __ATOMIC_ACQUIRE) == VP415SHM_MAGIC &&
+           channel->version == VP415SHM_VERSION &&
+           channel->ringSize == VP415SHM_RING_SIZE;
+}
+
+/* Number of bytes waiting to be read */
+static inline uint32_t vp415shm_available(vp415shm_ring *ring)
+{
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+}
+
+/* Spin-wait hint: lets a sibling hyperthread run (and saves power) while
+   a ring is being polled */
+static inline void vp415shm_pause(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+/* Wake the consumer of a ring (used by writers and on shutdown) */
+static inline void vp415shm_wake(vp415shm_ring *ring)
+{
+    syscall(SYS_futex, &ring->head, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+/* Producer: copy up to length bytes into the ring, returning the number
+   actually written (less than length if the ring is full) */
+static inline uint32_t vp415shm_write(vp415shm_ring *ring, const void *buffer, uint32_t length)
+{
+    const uint8_t *source = (const uint8_t *)buffer;
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    uint32_t space = VP415SHM_RING_SIZE - (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE));
+    uint32_t count = length < space ? length : space;
+    uint32_t offset = head & (VP415SHM_RING_SIZE - 1);
+    uint32_t first = count < VP415SHM_RING_SIZE - offset ? count : VP415SHM_RING_SIZE - offset;
+
+    if (count == 0) return 0;
+
+    memcpy(ring->data + offset, source, first);
+    memcpy(ring->data, source + first, count - first);
+
+    /* Publish the data, then check whether the consumer needs waking.  Both
+       sides use sequentially consistent operations here so that either the
+       consumer sees the new head or the producer sees the waiting flag. */
+    __atomic_store_n(&ring->head, head + count, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ring->waiting, __ATOMIC_SEQ_CST)) vp415shm_wake(ring);
+
+    return count;
+}
+
+/* Consumer: copy up to length bytes out of the ring, returning the number
+   actually read */
+static inline uint32_t vp415shm_read(vp415shm_ring *ring, void *buffer, uint32_t length)
+{
+    uint8_t *destination = (uint8_t *)buffer;
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    uint32_t available = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - tail;
+    uint32_t count = length < available ? length : available;
+    uint32_t offset = tail & (VP415SHM_RING_SIZE - 1);
+    uint32_t first = count < VP415SHM_RING_SIZE - offset ? count : VP415SHM_RING_SIZE - offset;
+
+    if (count == 0) return 0;
+
+    memcpy(destination, ring->data + offset, first);
+    memcpy(destination + first, ring->data, count - first);
+    __atomic_store_n(&ring->tail, tail + count, __ATOMIC_RELEASE);
+
+    return count;
+}
+
+/* Consumer: wait until data is available.  Spins briefly first, since a
+   futex wake-up costs several microseconds, then sleeps in the kernel.
+   timeoutNs of zero waits forever.  Returns the number of bytes available
+   (zero on timeout or spurious wake-up). */
+static inline uint32_t vp415shm_wait(vp415shm_ring *ring, uint64_t timeoutNs)
+{
+    uint32_t spin;
+    uint32_t tail;
+    struct timespec timeout;
+
+    for (spin = 0; spin < VP415SHM_SPIN_COUNT; spin++) {
+        uint32_t available = vp415shm_available(ring);
+        if (available) return available;
+        vp415shm_pause();
+    }
+
+    tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->waiting, 1u, __ATOMIC_SEQ_CST);
+
+    /* Only sleep if the head has not moved since it was last checked */
+    if (__atomic_load_n(&ring->head, __ATOMIC_SEQ_CST) == tail) {
+        timeout.tv_sec = (time_t)(timeoutNs / 1000000000u);
+        timeout.tv_nsec = (long)(timeoutNs % 1000000000u);
+        syscall(SYS_futex, &ring->head, FUTEX_WAIT, tail, timeoutNs ? &timeout : NULL, NULL, 0);
+    }
+
+    __atomic_store_n(&ring->waiting, 0u, __ATOMIC_SEQ_CST);
+    return vp415shm_available(ring);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VP415SHM_H */
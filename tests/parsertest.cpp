@@ -0,0 +1,298 @@
+/************************************************************************
+
+    parsertest.cpp
+
+    Serial parser unit tests
+    VP415Emu - VP415 LaserDisc player emulator for BeebSCSI
+    Copyright (C) 2017 Simon Inns
+
+    This file is part of VP415Emu.
+
+    VP415Emu is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Email: simon.inns@gmail.com
+
+************************************************************************/
+
+
+// Unit tests for the Qt-free serial parser.  Every row of the F-code
+// grammar is checked at the edges of its limits (the values just inside
+// are accepted, the values just outside are rejected) and the tag scanner
+// is checked with tags split across reads at every possible point.
+//
+// The program prints each failure and exits with a non-zero status if
+// there were any, so it can be run by ctest.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "tagdemux.h"
+#include "fcodedecoder.h"
+#include "fcodetable.h"
+
+static int failures = 0;
+static int checks = 0;
+
+static void check(bool condition, const std::string &what)
+{
+    checks++;
+    if (condition) return;
+
+    failures++;
+    std::fprintf(stderr, "FAILED: %s\n", what.c_str());
+}
+
+static std::string number(int32_t value)
+{
+    return std::to_string(value);
+}
+
+// Two digit decimal, as used for time code seconds and chapter sequences
+static std::string twoDigits(int32_t value)
+{
+    return (value < 10 ? "0" : "") + std::to_string(value);
+}
+
+// The F-code must decode as the row's command
+static void accept(const FcodeSyntax &syntax, const std::string &fcode)
+{
+    FcodeCommand command;
+    bool valid = FcodeDecoder::decode(fcode.data(), fcode.size(), command);
+
+    check(valid && command.opcode == syntax.opcode,
+          std::string(syntax.description) + ": \"" + fcode + "\" should be accepted (error: "
+          + FcodeDecoder::errorName(command.error) + ")");
+}
+
+// The F-code must be rejected, with the row's negative acknowledge if it
+// has one
+static void reject(const FcodeSyntax &syntax, const std::string &fcode)
+{
+    FcodeCommand command;
+    bool valid = FcodeDecoder::decode(fcode.data(), fcode.size(), command);
+
+    check(!valid, std::string(syntax.description) + ": \"" + fcode + "\" should be rejected");
+    check(valid || command.negativeAck == syntax.negativeAck ||
+          (command.negativeAck && syntax.negativeAck && std::strcmp(command.negativeAck, syntax.negativeAck) == 0),
+          std::string(syntax.description) + ": \"" + fcode + "\" gave the wrong negative acknowledge");
+}
+
+// Check the accept/reject boundaries of one grammar row
+static void testGrammarRow(const FcodeSyntax &syntax)
+{
+    const std::string code(1, syntax.code);
+    const std::string suffix = syntax.suffix ? std::string(1, syntax.suffix) : std::string();
+
+    switch (syntax.shape) {
+        case FcodeSyntax::shapeType::none:
+        accept(syntax, code);
+        reject(syntax, code + "Z");
+        break;
+
+        case FcodeSyntax::shapeType::selector:
+        accept(syntax, code + suffix);
+        reject(syntax, code + suffix + "0");
+        break;
+
+        case FcodeSyntax::shapeType::digitPair:
+        accept(syntax, code + number(syntax.minimumX) + number(syntax.minimumY));
+        accept(syntax, code + number(syntax.maximumX) + number(syntax.maximumY));
+        reject(syntax, code + number(syntax.minimumX));
+        reject(syntax, code + number(syntax.minimumX) + number(syntax.minimumY) + "0");
+        reject(syntax, code + "A" + number(syntax.minimumY));
+        break;
+
+        case FcodeSyntax::shapeType::bytePair:
+        accept(syntax, code + char(syntax.minimumX) + char(syntax.minimumY));
+        accept(syntax, code + char(syntax.maximumX) + char(syntax.maximumY));
+        reject(syntax, code + char(syntax.minimumX - 1) + char(syntax.minimumY));
+        reject(syntax, code + char(syntax.maximumX + 1) + char(syntax.minimumY));
+        reject(syntax, code + char(syntax.minimumX) + char(syntax.minimumY - 1));
+        reject(syntax, code + char(syntax.minimumX) + char(syntax.maximumY + 1));
+        reject(syntax, code + char(syntax.minimumX));
+        break;
+
+        case FcodeSyntax::shapeType::number:
+        accept(syntax, code + number(syntax.minimumX) + suffix);
+        accept(syntax, code + number(syntax.maximumX) + suffix);
+        if (syntax.minimumX > 0) reject(syntax, code + number(syntax.minimumX - 1) + suffix);
+        reject(syntax, code + number(syntax.maximumX + 1) + suffix);
+        if (syntax.suffix) reject(syntax, code + suffix);
+        break;
+
+        case FcodeSyntax::shapeType::numberJump:
+        accept(syntax, code + number(syntax.minimumX) + suffix + number(syntax.minimumY));
+        accept(syntax, code + number(syntax.maximumX) + suffix + number(syntax.maximumY));
+        reject(syntax, code + number(syntax.minimumX - 1) + suffix + number(syntax.minimumY));
+        reject(syntax, code + number(syntax.maximumX + 1) + suffix + number(syntax.minimumY));
+        reject(syntax, code + number(syntax.maximumX) + suffix + number(syntax.minimumY - 1));
+        reject(syntax, code + number(syntax.maximumX) + suffix + number(syntax.maximumY + 1));
+        reject(syntax, code + suffix + number(syntax.minimumY));
+        reject(syntax, code + number(syntax.maximumX) + suffix);
+
+        // No more than 20 pictures jumped per picture played
+        accept(syntax, code + "1" + suffix + "20");
+        reject(syntax, code + "1" + suffix + "21");
+        break;
+
+        case FcodeSyntax::shapeType::timeCode:
+        accept(syntax, code + number(syntax.minimumX) + suffix);
+        accept(syntax, code + number(syntax.maximumX) + suffix);
+        accept(syntax, code + twoDigits(syntax.minimumX) + twoDigits(syntax.minimumY) + suffix);
+        accept(syntax, code + twoDigits(syntax.maximumX) + twoDigits(syntax.maximumY) + suffix);
+        reject(syntax, code + number(syntax.maximumX + 1) + suffix);
+        reject(syntax, code + twoDigits(syntax.maximumX) + twoDigits(syntax.maximumY + 1) + suffix);
+        reject(syntax, code + twoDigits(syntax.maximumX) + "0" + suffix);
+        reject(syntax, code + suffix);
+        break;
+
+        case FcodeSyntax::shapeType::chapterSequence:
+        {
+            accept(syntax, code + number(syntax.minimumX) + suffix);
+            accept(syntax, code + number(syntax.maximumX) + suffix);
+            reject(syntax, code + number(syntax.maximumX + 1) + suffix);
+            reject(syntax, code + suffix);
+
+            // Up to the longest sequence, two digits per chapter
+            std::string sequence;
+            for (size_t i = 0; i < FcodeCommand::maximumSequenceLength; i++) sequence += twoDigits(syntax.maximumX);
+            accept(syntax, code + sequence + suffix);
+            reject(syntax, code + sequence + twoDigits(syntax.minimumX) + suffix);
+            reject(syntax, code + twoDigits(syntax.minimumX) + twoDigits(syntax.maximumX + 1) + suffix);
+            reject(syntax, code + twoDigits(syntax.minimumX) + "1" + suffix);
+            break;
+        }
+
+        case FcodeSyntax::shapeType::overlay:
+        accept(syntax, code + suffix + number(syntax.minimumX));
+        accept(syntax, code + suffix + number(syntax.maximumX));
+        accept(syntax, code + suffix + "X");
+        reject(syntax, code + suffix + number(syntax.minimumX - 1));
+        reject(syntax, code + suffix + number(syntax.maximumX + 1));
+        reject(syntax, code + suffix);
+        break;
+    }
+}
+
+static void testGrammar(void)
+{
+    for (size_t row = 0; row < fcodeTableSize; row++) testGrammarRow(fcodeTable[row]);
+
+    FcodeCommand command;
+    check(!FcodeDecoder::decode("", 0, command) && command.error == FcodeCommand::errorType::empty,
+          "empty F-code should be rejected as empty");
+    check(!FcodeDecoder::decode("~", 1, command) && command.error == FcodeCommand::errorType::unknownCode,
+          "unknown F-code should be rejected as unknown");
+}
+
+// Messages received by a scanner with FCODE and UCD tags
+struct Received {
+    std::vector<std::string> fcodes;
+    std::vector<std::string> userCodes;
+};
+
+static void addTags(TagDemux &demux, Received &received)
+{
+    demux.addTag("FCODE", [&received](const char *payload, size_t length) {
+        received.fcodes.push_back(std::string(payload, length));
+    });
+    demux.addTag("UCD", [&received](const char *payload, size_t length) {
+        received.userCodes.push_back(std::string(payload, length));
+    });
+}
+
+// Split the stream into two reads at every point, and also feed it one
+// byte at a time; the messages must come out the same every time
+static void testSplits(const std::string &stream, const std::vector<std::string> &fcodes,
+                       const std::vector<std::string> &userCodes)
+{
+    for (size_t split = 0; split <= stream.size(); split++) {
+        TagDemux demux;
+        Received received;
+        addTags(demux, received);
+
+        demux.putData(stream.data(), split);
+        demux.putData(stream.data() + split, stream.size() - split);
+
+        check(received.fcodes == fcodes && received.userCodes == userCodes,
+              "\"" + stream + "\" split after " + number(static_cast<int32_t>(split)) + " bytes");
+    }
+
+    TagDemux demux;
+    Received received;
+    addTags(demux, received);
+    for (char byte : stream) demux.putData(&byte, 1);
+
+    check(received.fcodes == fcodes && received.userCodes == userCodes, "\"" + stream + "\" one byte at a time");
+}
+
+static void testTagDemux(void)
+{
+    testSplits("<FCODE>F12345R</FCODE>", { "F12345R" }, {});
+
+    // Surrounding text and white space are not part of the message
+    testSplits("SCSI debug <FCODE> ,1\r\n</FCODE> more text", { ",1" }, {});
+
+    // Several messages in one stream, of both kinds
+    testSplits("<FCODE>?F</FCODE><UCD>Domesday</UCD><FCODE>N</FCODE>", { "?F", "N" }, { "Domesday" });
+
+    // Unknown tags are text, and a '<' in a payload that is not a tag is
+    // kept
+    testSplits("<DEBUG>x</DEBUG><FCODE>a<b</FCODE>", { "a<b" }, {});
+
+    // A message that is not closed is dropped when the next one starts
+    {
+        const std::string stream = "<FCODE>F1R<FCODE>F2R</FCODE>";
+        testSplits(stream, { "F2R" }, {});
+
+        TagDemux demux;
+        Received received;
+        addTags(demux, received);
+        demux.putData(stream.data(), stream.size());
+        check(demux.malformedTags() == 1, "unterminated message should be counted as malformed");
+    }
+
+    // A message too long for the payload buffer is dropped, and the
+    // scanner picks up the next one
+    {
+        const std::string stream = "<FCODE>" + std::string(TagDemux::maximumPayloadLength + 1, 'X')
+                + "</FCODE><FCODE>X</FCODE>";
+
+        TagDemux demux;
+        Received received;
+        addTags(demux, received);
+        demux.putData(stream.data(), stream.size());
+
+        check(received.fcodes == std::vector<std::string>({ "X" }), "over-long message should be dropped");
+        check(demux.malformedTags() == 1, "over-long message should be counted as malformed");
+    }
+
+    // A message exactly as long as the buffer is kept
+    {
+        const std::string payload(TagDemux::maximumPayloadLength, 'X');
+        testSplits("<FCODE>" + payload + "</FCODE>", { payload }, {});
+    }
+}
+
+int main(void)
+{
+    testGrammar();
+    testTagDemux();
+
+    std::printf("%d checks, %d failed\n", checks, failures);
+    return failures == 0 ? 0 : 1;
+}